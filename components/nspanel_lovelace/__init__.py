@@ -8,25 +8,29 @@ import logging
 from typing import Union
 import os, json
 
-from esphome.components import uart, time, esp32
+from esphome.components import uart, time, esp32, sensor
 from esphome.const import (
     CONF_ID,
     CONF_TRIGGER_ID,
     CONF_TIME_ID,
     CONF_ESPHOME,
-    CONF_PLATFORMIO_OPTIONS
+    CONF_PLATFORMIO_OPTIONS,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MILLISECOND
 )
 
 CODEOWNERS = ["@olicooper"]
 DEPENDENCIES = ["uart", "time", "wifi", "api", "esp32", "json"]
 
 def AUTO_LOAD():
-    val = ["text_sensor", "json"]
+    val = ["text_sensor", "sensor", "json"]
     return val
 
 _LOGGER = logging.getLogger(__name__)
 
 entity_ids: dict[str] = {}
+entity_usages: dict[str, set] = {}
 entity_id_index = 0
 uuid_index = 0
 iconJson = None
@@ -51,6 +55,16 @@ TEMPERATURE_UNIT_OPTION_MAP = {
     'fahrenheit': TEMPERATURE_UNIT.fahrenheit,
 }
 
+COMMAND_PACING = nspanel_lovelace_ns.enum("command_pacing_t", True)
+COMMAND_PACING_OPTIONS = ['fixed','adaptive']
+COMMAND_PACING_OPTION_MAP = {
+    'fixed': COMMAND_PACING.fixed,
+    'adaptive': COMMAND_PACING.adaptive,
+}
+
+LATENCY_STAGE = nspanel_lovelace_ns.enum("latency_stage", True)
+LATENCY_STAGE_OPTIONS = ['event','handler','home_assistant','render','display','total']
+
 NSPanelLovelaceMsgIncomingTrigger = nspanel_lovelace_ns.class_(
     "NSPanelLovelaceMsgIncomingTrigger",
     automation.Trigger.template(cg.std_string)
@@ -117,6 +131,12 @@ CONF_ICON_VALUE = "value"
 CONF_ICON_COLOR = "color"
 CONF_ENTITY_ID = "entity_id"
 CONF_SLEEP_TIMEOUT = "sleep_timeout"
+CONF_COMMAND_PACING = "command_pacing"
+CONF_RENDER_FRAME_RATE = "render_frame_rate"
+CONF_HIGH_BAUD_RATE = "high_baud_rate"
+CONF_UART_RX_EVENTS = "uart_rx_events"
+CONF_TRAFFIC_CAPTURE_SIZE = "traffic_capture_size"
+CONF_LATENCY_SENSORS = "latency_sensors"
 
 CONF_LOCALE = "locale"
 CONF_TEMPERATURE_UNIT = "temperature_unit"
@@ -148,6 +168,79 @@ CARD_THERMO="cardThermo"
 CARD_MEDIA="cardMedia"
 CARD_TYPE_OPTIONS = [CARD_ENTITIES, CARD_GRID, CARD_GRID2, CARD_QR, CARD_ALARM, CARD_THERMO, CARD_MEDIA]
 
+# How an entity is shown, which decides the attributes it needs from HA
+ENTITY_USAGE_ICON = "icon" # the icon of any item showing the entity
+ENTITY_USAGE_ITEM = "item" # an item on a card and the popup it opens
+ENTITY_USAGE_STATUS_ICON = "status_icon" # a screensaver status icon
+ENTITY_USAGE_CARD = "card" # the entity of an alarm, thermo or media card
+
+# Entity domains which subscribe to the state
+HA_STATE_DOMAINS = [
+    "light", "switch", "input_boolean", "input_text", "text", "automation", "sun",
+    "vacuum", "lock", "person", "sensor", "binary_sensor", "cover", "alarm_control_panel",
+    "timer", "climate", "media_player", "select", "input_select", "number", "input_number",
+    "weather", "fan",
+]
+# The attributes (ha_attr_type) each usage of an entity domain reads,
+# see default_entity_subscriptions_ in nspanel_lovelace.cpp for the defaults
+CLIMATE_POPUP_ATTRIBUTES = [
+    "preset_modes", "preset_mode", "swing_modes", "swing_mode", "fan_modes", "fan_mode"]
+HA_ATTRIBUTE_MAP = {
+    "light": {
+        # need to subscribe to brightness to know if brightness is supported
+        ENTITY_USAGE_ITEM: ["supported_color_modes", "color_mode", "min_mireds", "max_mireds",
+            "color_temp", "brightness", "effect_list"],
+    },
+    "sensor": {
+        ENTITY_USAGE_ICON: ["device_class"],
+        ENTITY_USAGE_ITEM: ["unit_of_measurement"],
+    },
+    "binary_sensor": {
+        ENTITY_USAGE_ICON: ["device_class"],
+        ENTITY_USAGE_ITEM: ["unit_of_measurement"],
+    },
+    "cover": {
+        ENTITY_USAGE_ICON: ["device_class"],
+        ENTITY_USAGE_ITEM: ["supported_features", "current_position", "current_tilt_position"],
+    },
+    "alarm_control_panel": {
+        ENTITY_USAGE_CARD: ["code_arm_required", "open_sensors"],
+    },
+    "timer": {
+        ENTITY_USAGE_ITEM: ["editable", "duration", "remaining", "finishes_at"],
+    },
+    "climate": {
+        ENTITY_USAGE_ITEM: ["temperature", "current_temperature", *CLIMATE_POPUP_ATTRIBUTES],
+        ENTITY_USAGE_CARD: ["temperature", "current_temperature", "target_temp_high",
+            "target_temp_low", "target_temp_step", "min_temp", "max_temp", "hvac_action",
+            "hvac_modes", *CLIMATE_POPUP_ATTRIBUTES],
+    },
+    "media_player": {
+        ENTITY_USAGE_ICON: ["media_content_type"],
+        ENTITY_USAGE_ITEM: ["source", "source_list"],
+        ENTITY_USAGE_CARD: ["supported_features", "media_title", "media_artist",
+            "volume_level", "shuffle", "source", "source_list"],
+    },
+    "select": {
+        ENTITY_USAGE_ITEM: ["options"],
+    },
+    "input_select": {
+        ENTITY_USAGE_ITEM: ["options"],
+    },
+    "number": {
+        ENTITY_USAGE_ITEM: ["min", "max"],
+    },
+    "input_number": {
+        ENTITY_USAGE_ITEM: ["min", "max"],
+    },
+    "weather": {
+        ENTITY_USAGE_ITEM: ["temperature", "temperature_unit"],
+    },
+    "fan": {
+        ENTITY_USAGE_ITEM: ["percentage_step", "percentage", "preset_modes", "preset_mode"],
+    },
+}
+
 CONF_CARD_QR_TEXT = "qr_text"
 CONF_CARD_ALARM_ENTITY_ID = "alarm_entity_id"
 CONF_CARD_ALARM_SUPPORTED_MODES = "supported_modes"
@@ -352,11 +445,24 @@ SCHEMA_CARD_BASE = cv.Schema({
     cv.Optional(CONF_CARD_SLEEP_TIMEOUT, default=10): cv.int_range(2, 43200)
 })
 
-def add_entity_id(id: str):
+def add_entity_id(id: str, usage: str = ENTITY_USAGE_ITEM):
     global entity_ids, entity_id_index
     if (entity_ids.get(id, None) is None):
         entity_ids[id] = f"nspanel_e{entity_id_index}"
         entity_id_index += 1
+    entity_usages.setdefault(id, set()).add(usage)
+
+def get_entity_subscriptions(entity_id: str) -> list[str]:
+    domain = entity_id.split('.', 1)[0]
+    if domain not in HA_STATE_DOMAINS:
+        return []
+    attributes = ["state"]
+    usages = HA_ATTRIBUTE_MAP.get(domain, {})
+    for usage in [ENTITY_USAGE_ICON, *sorted(entity_usages.get(entity_id, []))]:
+        for attr in usages.get(usage, []):
+            if attr not in attributes:
+                attributes.append(attr)
+    return attributes
 
 def get_card_entities_length_limits(card_type: str, model: str = 'eu') -> list[int]:
     if (card_type == CARD_ENTITIES):
@@ -375,6 +481,8 @@ def validate_config(config):
     model = config[CONF_MODEL]
     if CONF_LANGUAGE not in config[CONF_LOCALE]:
         raise cv.Invalid("A language must be specified in locale")
+    if config[CONF_UART_RX_EVENTS] and not core.CORE.using_esp_idf:
+        raise cv.Invalid("uart_rx_events requires the esp-idf framework", path=[CONF_UART_RX_EVENTS])
     # Build a list of custom card ids
     card_ids = []
     for card_config in config.get(CONF_CARDS, []):
@@ -408,20 +516,20 @@ def validate_config(config):
             if not entity_id.startswith('delete'):
                 add_entity_id(entity_id)
         if CONF_CARD_ALARM_ENTITY_ID in card_config:
-            add_entity_id(card_config.get(CONF_CARD_ALARM_ENTITY_ID))
+            add_entity_id(card_config.get(CONF_CARD_ALARM_ENTITY_ID), ENTITY_USAGE_CARD)
         if CONF_CARD_THERMO_ENTITY_ID in card_config:
-            add_entity_id(card_config.get(CONF_CARD_THERMO_ENTITY_ID))
+            add_entity_id(card_config.get(CONF_CARD_THERMO_ENTITY_ID), ENTITY_USAGE_CARD)
         if CONF_CARD_MEDIA_ENTITY_ID in card_config:
-            add_entity_id(card_config.get(CONF_CARD_MEDIA_ENTITY_ID))
+            add_entity_id(card_config.get(CONF_CARD_MEDIA_ENTITY_ID), ENTITY_USAGE_CARD)
 
     if CONF_SCREENSAVER in config:
         screensaver_config = config.get(CONF_SCREENSAVER)
         left = screensaver_config.get(CONF_SCREENSAVER_STATUS_ICON_LEFT, None)
         right = screensaver_config.get(CONF_SCREENSAVER_STATUS_ICON_RIGHT, None)
         if left and CONF_ENTITY_ID in left:
-            add_entity_id(left.get(CONF_ENTITY_ID))
+            add_entity_id(left.get(CONF_ENTITY_ID), ENTITY_USAGE_STATUS_ICON)
         if right and CONF_ENTITY_ID in right:
-            add_entity_id(right.get(CONF_ENTITY_ID))
+            add_entity_id(right.get(CONF_ENTITY_ID), ENTITY_USAGE_STATUS_ICON)
 
     return config
 
@@ -430,6 +538,21 @@ CONFIG_SCHEMA = cv.All(
         cv.GenerateID(): cv.declare_id(NSPanelLovelace),
         cv.Optional(CONF_SLEEP_TIMEOUT, default=10): cv.int_range(2, 43200),
         cv.Optional(CONF_MODEL, default='eu'): cv.one_of('eu', 'us-l', 'us-p'),
+        cv.Optional(CONF_COMMAND_PACING, default='fixed'): cv.one_of(*COMMAND_PACING_OPTIONS),
+        cv.Optional(CONF_RENDER_FRAME_RATE, default=5): cv.int_range(1, 20),
+        # rates supported by the Nextion above the default 115200 baud
+        cv.Optional(CONF_HIGH_BAUD_RATE): cv.one_of(230400, 250000, 256000, 512000, 921600),
+        cv.Optional(CONF_UART_RX_EVENTS, default=False): cv.boolean,
+        cv.Optional(CONF_TRAFFIC_CAPTURE_SIZE): cv.int_range(1024, 1048576),
+        cv.Optional(CONF_LATENCY_SENSORS): cv.Schema({
+            cv.Optional(stage): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                icon="mdi:timer-outline",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ) for stage in LATENCY_STAGE_OPTIONS
+        }),
         cv.Optional(CONF_LOCALE, default={}): SCHEMA_LOCALE,
         cv.Optional(CONF_SCREENSAVER, default={}): SCHEMA_SCREENSAVER,
         cv.Optional(CONF_INCOMING_MSG): automation.validate_automation(
@@ -501,6 +624,8 @@ GridCardEntityItem = nspanel_lovelace_ns.class_("GridCardEntityItem")
 AlarmButtonItem = nspanel_lovelace_ns.class_("AlarmButtonItem")
 
 PageType = nspanel_lovelace_ns.enum("page_type", True)
+HA_ATTR_TYPE = nspanel_lovelace_ns.enum("ha_attr_type", True)
+EntitySubscription = nspanel_lovelace_ns.struct("entity_subscription")
 
 PAGE_MAP = {
     # [config type] : [c++ variable name prefix], [card class], [card type], [entity class]
@@ -646,6 +771,23 @@ async def to_code(config):
     if CONF_SLEEP_TIMEOUT in config:
         cg.add(nspanel.set_display_timeout(config[CONF_SLEEP_TIMEOUT]))
 
+    cg.add(nspanel.set_command_pacing(COMMAND_PACING_OPTION_MAP[config[CONF_COMMAND_PACING]]))
+    cg.add(nspanel.set_render_frame_rate(config[CONF_RENDER_FRAME_RATE]))
+
+    if CONF_HIGH_BAUD_RATE in config:
+        cg.add(nspanel.set_high_baud_rate(config[CONF_HIGH_BAUD_RATE]))
+
+    if config[CONF_UART_RX_EVENTS]:
+        cg.add_build_flag("-DUSE_NSPANEL_UART_EVENTS")
+
+    if CONF_TRAFFIC_CAPTURE_SIZE in config:
+        cg.add_build_flag("-DUSE_NSPANEL_TRAFFIC_CAPTURE")
+        cg.add(nspanel.set_traffic_capture_size(config[CONF_TRAFFIC_CAPTURE_SIZE]))
+
+    for stage, sensor_config in config.get(CONF_LATENCY_SENSORS, {}).items():
+        sens = await sensor.new_sensor(sensor_config)
+        cg.add(nspanel.set_latency_sensor(getattr(LATENCY_STAGE, stage), sens))
+
     locale_config = config[CONF_LOCALE]
     global translationJson
     load_translations(locale_config[CONF_LANGUAGE])
@@ -678,6 +820,18 @@ async def to_code(config):
     for key, value in entity_ids.items():
         cg.add(cg.RawExpression(f"auto {value} = {nspanel.create_entity(key)}"))
 
+    # only subscribe to what the cards and popups showing each entity read
+    if len(entity_ids) > 0:
+        subscriptions = []
+        for key in entity_ids.keys():
+            attributes = [getattr(HA_ATTR_TYPE, attr) for attr in get_entity_subscriptions(key)]
+            subscriptions.append(cg.ArrayInitializer(key, nspanel_lovelace_ns.ha_attr_mask(*attributes)))
+        cg.add_global(cg.RawStatement(
+            f"static const {EntitySubscription} NSPANEL_SUBSCRIPTIONS[] = "
+            f"{cg.ArrayInitializer(*subscriptions, multiline=True)};"))
+        cg.add(nspanel.set_entity_subscriptions(
+            cg.RawExpression("NSPANEL_SUBSCRIPTIONS"), len(subscriptions)))
+
     screensaver_config = config.get(CONF_SCREENSAVER, None)
     screensaver_uuid = None
     if screensaver_config is not None:
@@ -0,0 +1,131 @@
+#include "attribute_list.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "helpers.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+AttributeList::AttributeList(AttributeList &&other) : data_(other.data_) {
+  other.data_ = nullptr;
+}
+
+AttributeList &AttributeList::operator=(AttributeList &&other) {
+  if (this != &other) {
+    this->clear();
+    std::swap(this->data_, other.data_);
+  }
+  return *this;
+}
+
+AttributeList::~AttributeList() { this->clear(); }
+
+void AttributeList::clear() {
+  if (this->data_ != nullptr) SpiRamAllocator().deallocate(this->data_);
+  this->data_ = nullptr;
+}
+
+static bool is_space_(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+void AttributeList::parse(const std::string &value, uint16_t max_items) {
+  this->clear();
+
+  // collect the items first, the final size is only known at the end
+  std::string text;
+  std::vector<uint16_t> offsets;
+  size_t pos = 0, length = value.length();
+  while (pos < length && is_space_(value[pos])) pos++;
+  char close = '\0';
+  if (pos < length && (value[pos] == '[' || value[pos] == '(' || value[pos] == '{')) {
+    close = value[pos] == '[' ? ']' : value[pos] == '(' ? ')' : '}';
+    pos++;
+  }
+
+  while (pos < length && offsets.size() < max_items) {
+    while (pos < length && is_space_(value[pos])) pos++;
+    if (pos >= length || value[pos] == close) break;
+
+    auto start = text.length();
+    char quote = value[pos];
+    if (quote == '\'' || quote == '"') {
+      // quoted items end at the matching unescaped quote and may contain commas
+      for (pos++; pos < length && value[pos] != quote; pos++) {
+        if (value[pos] == '\\' && pos + 1 < length) pos++;
+        text.append(1, value[pos]);
+      }
+      pos++;
+      // skip anything up to the next item, including the value of a dict entry
+      quote = '\0';
+      for (; pos < length; pos++) {
+        if (quote != '\0') {
+          if (value[pos] == '\\') pos++;
+          else if (value[pos] == quote) quote = '\0';
+        } else if (value[pos] == '\'' || value[pos] == '"') {
+          quote = value[pos];
+        } else if (value[pos] == ',' || value[pos] == close) {
+          break;
+        }
+      }
+    } else {
+      auto end = pos;
+      while (end < length && value[end] != ',' && value[end] != close) end++;
+      auto last = end;
+      while (last > pos && is_space_(value[last - 1])) last--;
+      text.append(value, pos, last - pos);
+      pos = end;
+    }
+    if (pos < length && value[pos] == ',') pos++;
+
+    if (text.length() == start) continue;
+    if (text.length() >= UINT16_MAX) {
+      text.resize(start);
+      break;
+    }
+    offsets.push_back(start);
+    text.append(1, '\0');
+  }
+  if (offsets.empty()) return;
+
+  auto count = offsets.size();
+  auto header = (count + 2) * sizeof(uint16_t);
+  this->data_ = static_cast<uint16_t *>(SpiRamAllocator().allocate(header + text.length()));
+  if (this->data_ == nullptr) return;
+  this->data_[0] = count;
+  std::memcpy(this->data_ + 1, offsets.data(), count * sizeof(uint16_t));
+  this->data_[count + 1] = text.length();
+  std::memcpy(reinterpret_cast<char *>(this->data_) + header, text.data(), text.length());
+}
+
+const char *AttributeList::at(uint16_t index) const {
+  if (index >= this->size()) return "";
+  return this->text_() + this->data_[index + 1];
+}
+
+bool AttributeList::contains(const char *value) const {
+  for (uint16_t i = 0; i < this->size(); i++) {
+    if (std::strcmp(this->at(i), value) == 0) return true;
+  }
+  return false;
+}
+
+std::string &AttributeList::join(std::string &buffer, char delimiter) const {
+  auto count = this->size();
+  if (count == 0) return buffer;
+  // the items are already separated by a null character
+  auto start = buffer.length();
+  buffer.append(this->text_(), this->data_[count + 1] - 1);
+  for (auto i = start; i < buffer.length(); i++) {
+    if (buffer[i] == '\0') buffer[i] = delimiter;
+  }
+  return buffer;
+}
+
+size_t AttributeList::get_memory() const {
+  if (this->data_ == nullptr) return 0;
+  return (this->size() + 2) * sizeof(uint16_t) + this->data_[this->size() + 1];
+}
+
+}
+}
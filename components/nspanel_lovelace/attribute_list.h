@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// The items of a list attribute, i.e. "['Radio', 'TV, HDMI 1', \"Kid's room\"]",
+// parsed into a single allocation (in PSRAM when available) that holds the
+// item count, the offset of each item and the null terminated items.
+class AttributeList {
+public:
+  AttributeList() = default;
+  AttributeList(AttributeList &&other);
+  AttributeList &operator=(AttributeList &&other);
+  AttributeList(const AttributeList &) = delete;
+  AttributeList &operator=(const AttributeList &) = delete;
+  ~AttributeList();
+
+  // Parses the Python representation of a list (or the keys of a dict), quoted items may
+  // contain commas. Values that aren't a list are split at commas, empty items are skipped.
+  void parse(const std::string &value, uint16_t max_items = UINT16_MAX);
+  void clear();
+
+  uint16_t size() const { return this->data_ == nullptr ? 0 : this->data_[0]; }
+  bool empty() const { return this->size() == 0; }
+  // The item at 'index', or an empty string when out of range
+  const char *at(uint16_t index) const;
+  bool contains(const char *value) const;
+  // Appends the items separated by 'delimiter'
+  std::string &join(std::string &buffer, char delimiter) const;
+
+  size_t get_memory() const;
+
+protected:
+  const char *text_() const {
+    return reinterpret_cast<const char *>(this->data_ + this->size() + 2);
+  }
+
+  // [count, offset of item 0..count (the last one is the text length)] + text
+  uint16_t *data_ = nullptr;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
@@ -0,0 +1,91 @@
+#include "button_coalescer.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+ButtonCoalescer::ButtonCoalescer() {
+  for (auto &s : this->slots_) {
+    s.internal_id.reserve(64);
+    s.button_type.reserve(24);
+    s.value.reserve(24);
+  }
+  this->probe_entity_id_.reserve(64);
+}
+
+ButtonCoalescer::slot &ButtonCoalescer::get_slot_(
+    const str_span &internal_id, const str_span &button_type, uint32_t now, bool &found) {
+  slot *lru = nullptr;
+  for (auto &s : this->slots_) {
+    if (internal_id == s.internal_id && button_type == s.button_type) {
+      found = true;
+      return s;
+    }
+    if (lru == nullptr || (now - s.last_used) > (now - lru->last_used)) lru = &s;
+  }
+  found = false;
+  // the least recently used control gives up its slot, after handling its pending value
+  if (lru->pending) this->handle_(*lru, now);
+  lru->internal_id.assign(internal_id.data, internal_id.length);
+  lru->button_type.assign(button_type.data, button_type.length);
+  return *lru;
+}
+
+void ButtonCoalescer::push(const str_span &internal_id, const str_span &button_type,
+    const str_span &value, uint32_t received_at, uint32_t now) {
+  bool found;
+  auto &s = this->get_slot_(internal_id, button_type, now, found);
+  s.last_used = now;
+  if (s.pending) this->coalesced_count_++;
+  s.value.assign(value.data, value.length);
+  s.received_at = received_at;
+
+  if (!found || (!s.pending && (now - s.last_handled) >= this->interval_)) {
+    // leading edge
+    this->handle_(s, now);
+  } else if (!s.pending) {
+    // trailing edge, handled by loop()
+    s.pending = true;
+    this->pending_count_++;
+  }
+}
+
+void ButtonCoalescer::loop(uint32_t now) {
+  if (this->pending_count_ == 0) return;
+  for (auto &s : this->slots_) {
+    if (s.pending && (now - s.last_handled) >= this->interval_)
+      this->handle_(s, now);
+  }
+}
+
+void ButtonCoalescer::handle_(slot &s, uint32_t now) {
+  if (s.pending) {
+    s.pending = false;
+    this->pending_count_--;
+  }
+  s.last_handled = now;
+  if (this->handler_) this->handler_(s.internal_id, s.button_type, s.value, s.received_at);
+}
+
+void ButtonCoalescer::on_service_call(const std::string &entity_id, uint32_t now) {
+  // one measurement at a time, calls that don't change anything never get an update
+  if (this->probe_active_ && (now - this->probe_sent_) < BUTTON_COALESCE_MAX_INTERVAL) return;
+  this->probe_entity_id_ = entity_id;
+  this->probe_sent_ = now;
+  this->probe_active_ = true;
+}
+
+void ButtonCoalescer::on_state_update(const std::string &entity_id, uint32_t now) {
+  if (!this->probe_active_ || entity_id != this->probe_entity_id_) return;
+  this->probe_active_ = false;
+  uint32_t round_trip = now - this->probe_sent_;
+  if (round_trip >= BUTTON_COALESCE_MAX_INTERVAL) return;
+  // smooth out the odd slow response
+  this->round_trip_ = (this->round_trip_ * 3 + round_trip) / 4;
+  this->interval_ = std::max<uint32_t>(BUTTON_COALESCE_MIN_INTERVAL,
+    std::min<uint32_t>(this->round_trip_, BUTTON_COALESCE_MAX_INTERVAL));
+}
+
+}
+}
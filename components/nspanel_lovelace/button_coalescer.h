@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <stdint.h>
+#include <string>
+
+#include "config.h"
+#include "helpers.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// Coalesces the events of controls that fire repeatedly (sliders, colour wheel etc.)
+// so Home Assistant isn't flooded with service calls.
+//
+// Each control (internal id + button type) gets a slot of its own, so touching
+// another control doesn't drop a pending value. The first event of a control is
+// handled straight away, later events within the interval only replace the pending
+// value which is handled once the interval has passed.
+// The interval follows the measured time from a service call to the resulting
+// state update from Home Assistant.
+class ButtonCoalescer {
+public:
+  // 'received_at' is the time the TFT frame of the handled value arrived
+  typedef std::function<void(const std::string &internal_id,
+    const std::string &button_type, const std::string &value, uint32_t received_at)> handler_t;
+
+  ButtonCoalescer();
+
+  void set_handler(handler_t &&handler) { this->handler_ = std::move(handler); }
+
+  // Handles the event now, or once the interval of its control has passed
+  void push(const str_span &internal_id, const str_span &button_type,
+    const str_span &value, uint32_t received_at, uint32_t now);
+  // Handles the pending values whose interval has passed
+  void loop(uint32_t now);
+  bool has_pending() const { return this->pending_count_ > 0; }
+
+  // Round trip measurement
+  void on_service_call(const std::string &entity_id, uint32_t now);
+  void on_state_update(const std::string &entity_id, uint32_t now);
+
+  uint32_t get_interval() const { return this->interval_; }
+  uint32_t get_round_trip() const { return this->round_trip_; }
+  // Events that were replaced by a later value before being handled
+  uint32_t get_coalesced_count() const { return this->coalesced_count_; }
+
+protected:
+  struct slot {
+    std::string internal_id;
+    std::string button_type;
+    std::string value;
+    // frame time of 'value'
+    uint32_t received_at = 0;
+    uint32_t last_handled = 0;
+    uint32_t last_used = 0;
+    bool pending = false;
+  };
+
+  slot &get_slot_(const str_span &internal_id, const str_span &button_type, uint32_t now, bool &found);
+  void handle_(slot &s, uint32_t now);
+
+  handler_t handler_;
+  std::array<slot, BUTTON_COALESCE_SLOTS> slots_;
+  uint8_t pending_count_ = 0;
+  uint32_t interval_ = BUTTON_COALESCE_DEFAULT_INTERVAL;
+  uint32_t round_trip_ = BUTTON_COALESCE_DEFAULT_INTERVAL;
+  uint32_t coalesced_count_ = 0;
+
+  std::string probe_entity_id_;
+  uint32_t probe_sent_ = 0;
+  bool probe_active_ = false;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
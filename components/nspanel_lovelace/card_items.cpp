@@ -104,9 +104,25 @@ void EntitiesCardEntityItem::on_entity_attribute_change(
   this->set_render_invalid();
 }
 
+ha_attr_mask_t EntitiesCardEntityItem::get_subscribed_attributes_(const char *type) const {
+  auto attributes = StatefulPageItem::get_subscribed_attributes_(type) |
+    ha_attr_mask(ha_attr_type::unit_of_measurement);
+  // attributes which also require updating the state, see on_entity_attribute_change
+  if (type == entity_type::cover || type == entity_type::media_player) {
+    return ALL_HA_ATTRIBUTES;
+  } else if (type == entity_type::climate) {
+    attributes |= ha_attr_mask(ha_attr_type::temperature, ha_attr_type::current_temperature);
+  } else if (type == entity_type::number || type == entity_type::input_number) {
+    attributes |= ha_attr_mask(ha_attr_type::min, ha_attr_type::max);
+  } else if (type == entity_type::weather) {
+    attributes |= ha_attr_mask(ha_attr_type::temperature, ha_attr_type::temperature_unit);
+  }
+  return attributes;
+}
+
 void EntitiesCardEntityItem::state_generic_fn(StatefulPageItem *me) {
   auto me_ = static_cast<EntitiesCardEntityItem*>(me);
-  me_->value_ = get_translation(me_->get_state());
+  me_->value_ = me_->get_state_translation();
 }
 
 void EntitiesCardEntityItem::state_on_off_fn(StatefulPageItem *me) {
@@ -133,9 +149,8 @@ void EntitiesCardEntityItem::state_script_fn(StatefulPageItem *me) {
 
 void EntitiesCardEntityItem::state_timer_fn(StatefulPageItem *me) {
   auto me_ = static_cast<EntitiesCardEntityItem*>(me);
-  auto &state = me_->get_entity()->get_state();
   // backend.component.timer.state
-  me_->value_ = get_translation(state);
+  me_->value_ = me_->get_state_translation();
 }
 
 void EntitiesCardEntityItem::state_cover_fn(StatefulPageItem *me) {
@@ -149,24 +164,15 @@ void EntitiesCardEntityItem::state_cover_fn(StatefulPageItem *me) {
     entity_cover_type::window);
   auto &position_str = me_->get_attribute(
     ha_attr_type::current_position);
-  auto &supported_features_str = me_->get_attribute(
-    ha_attr_type::supported_features);
 
-  uint8_t position = 0;
-  uint8_t supported_features = 0;
+  uint8_t position = me_->get_attribute_number(ha_attr_type::current_position, 0);
+  uint8_t supported_features = me_->get_attribute_number(ha_attr_type::supported_features, 0);
   bool icon_up_status = false;
   bool icon_stop_status = false;
   bool icon_down_status = false;
 
   me_->value_.clear();
 
-  if (!position_str.empty()) {
-    position = std::stoi(position_str);
-  }
-  if (!supported_features_str.empty()) {
-    supported_features = std::stoi(supported_features_str);
-  }
-
   // see: https://github.com/home-assistant/core/blob/dev/homeassistant/components/cover/__init__.py#L112
   // OPEN
   if (supported_features & 0b1) {
@@ -209,7 +215,7 @@ void EntitiesCardEntityItem::state_climate_fn(StatefulPageItem *me) {
   auto me_ = static_cast<EntitiesCardEntityItem*>(me);
 
   // backend.component.climate.state
-  me_->value_.assign(get_translation(me_->get_state()));
+  me_->value_.assign(me_->get_state_translation());
   if (me_->is_state(entity_state::unknown)) return;
   
   auto temp_unit = Configuration::get_temperature_unit_str();
@@ -225,7 +231,7 @@ void EntitiesCardEntityItem::state_climate_fn(StatefulPageItem *me) {
 
 void EntitiesCardEntityItem::state_number_fn(StatefulPageItem *me) {
   auto me_ = static_cast<EntitiesCardEntityItem*>(me);
-  auto &state = me_->get_entity()->get_state();
+  auto state = me_->get_state();
   auto min = me_->get_attribute(ha_attr_type::min, "0");
   auto max = me_->get_attribute(ha_attr_type::max, "100");
   
@@ -257,7 +263,7 @@ void EntitiesCardEntityItem::state_sun_fn(StatefulPageItem *me) {
   StatefulPageItem::state_sun_fn(me);
   auto me_ = static_cast<EntitiesCardEntityItem*>(me);
   // backend.component.sun.state
-  me_->value_ = get_translation(me_->get_state());
+  me_->value_ = me_->get_state_translation();
 }
 
 void EntitiesCardEntityItem::state_vacuum_fn(StatefulPageItem *me) {
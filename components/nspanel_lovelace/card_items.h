@@ -62,6 +62,7 @@ protected:
   static void state_translate_fn(StatefulPageItem *me);
 
   void set_on_state_callback_(const char *type) override;
+  ha_attr_mask_t get_subscribed_attributes_(const char *type) const override;
 
   // output: type~internalName~icon~iconColor~displayName~value
   std::string &render_(std::string &buffer) override;
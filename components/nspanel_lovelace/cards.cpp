@@ -57,7 +57,8 @@ AlarmCard::AlarmCard(
     Card(page_type::cardAlarm, uuid),
     alarm_entity_(alarm_entity),
     show_keypad_(true), status_icon_flashing_(false) {
-  alarm_entity_->add_subscriber(this);
+  alarm_entity_->add_subscriber(this,
+    ha_attr_mask(ha_attr_type::state, ha_attr_type::code_arm_required));
   this->status_icon_ = std::unique_ptr<AlarmIconItem>(
     new AlarmIconItem(std::string(uuid).append("_s"), icon_t::shield_off, 0x0CE6)); //green
   this->info_icon_ = std::unique_ptr<AlarmIconItem>(
@@ -72,7 +73,8 @@ AlarmCard::AlarmCard(
     Card(page_type::cardAlarm, uuid, title),
     alarm_entity_(alarm_entity),
     show_keypad_(true),status_icon_flashing_(false) {
-  alarm_entity_->add_subscriber(this);
+  alarm_entity_->add_subscriber(this,
+    ha_attr_mask(ha_attr_type::state, ha_attr_type::code_arm_required));
   this->status_icon_ = std::unique_ptr<AlarmIconItem>(
     new AlarmIconItem(std::string(uuid).append("_s"), icon_t::shield_off, 0x0CE6)); //green
   this->info_icon_ = std::unique_ptr<AlarmIconItem>(
@@ -87,7 +89,8 @@ AlarmCard::AlarmCard(
     Card(page_type::cardAlarm, uuid, title, sleep_timeout),
     alarm_entity_(alarm_entity),
     show_keypad_(true),status_icon_flashing_(false) {
-  alarm_entity_->add_subscriber(this);
+  alarm_entity_->add_subscriber(this,
+    ha_attr_mask(ha_attr_type::state, ha_attr_type::code_arm_required));
   this->status_icon_ = std::unique_ptr<AlarmIconItem>(
     new AlarmIconItem(std::string(uuid).append("_s"), icon_t::shield_off, 0x0CE6)); //green
   this->info_icon_ = std::unique_ptr<AlarmIconItem>(
@@ -135,12 +138,12 @@ bool AlarmCard::add_arm_button(alarm_arm_action action) {
   return true;
 }
 
-void AlarmCard::on_entity_state_change(const std::string &state) {
+void AlarmCard::on_entity_state_change(const char *state) {
   this->status_icon_flashing_ = false;
 
-  if (state == entity_state::triggered || 
-      state == entity_state::arming || 
-      state == entity_state::pending) {
+  if (this->alarm_entity_->is_state(entity_state::triggered) || 
+      this->alarm_entity_->is_state(entity_state::arming) || 
+      this->alarm_entity_->is_state(entity_state::pending)) {
     this->status_icon_flashing_ = true;
   }
 
@@ -208,7 +211,8 @@ ThermoCard::ThermoCard(const std::string &uuid,
     Card(page_type::cardThermo, uuid),
     thermo_entity_(thermo_entity) {
   this->configure_temperature_unit();
-  thermo_entity->add_subscriber(this);
+  // the card reads the entity when it is rendered
+  thermo_entity->add_subscriber(this, ha_attr_mask());
 }
 
 ThermoCard::ThermoCard(const std::string &uuid,
@@ -217,7 +221,8 @@ ThermoCard::ThermoCard(const std::string &uuid,
     Card(page_type::cardThermo, uuid, title),
     thermo_entity_(thermo_entity) {
   this->configure_temperature_unit();
-  thermo_entity->add_subscriber(this);
+  // the card reads the entity when it is rendered
+  thermo_entity->add_subscriber(this, ha_attr_mask());
 }
 
 ThermoCard::ThermoCard(
@@ -227,7 +232,8 @@ ThermoCard::ThermoCard(
     Card(page_type::cardThermo, uuid, title, sleep_timeout),
     thermo_entity_(thermo_entity) {
   this->configure_temperature_unit();
-  thermo_entity->add_subscriber(this);
+  // the card reads the entity when it is rendered
+  thermo_entity->add_subscriber(this, ha_attr_mask());
 }
 
 ThermoCard::~ThermoCard() {
@@ -262,24 +268,23 @@ std::string &ThermoCard::render(std::string &buffer) {
   buffer.append(Configuration::get_temperature_unit_str());
   buffer.append(1, SEPARATOR);
 
-  std::string dest_temp_str = 
-    this->thermo_entity_->get_attribute(ha_attr_type::temperature);
+  // temperatures are sent in tenths of a degree
+  int32_t dest_temp;
   std::string dest_temp2_str;
 
-  if (dest_temp_str.empty()) {
-    dest_temp_str = this->thermo_entity_->get_attribute(
-      ha_attr_type::target_temp_high, "0");
-    dest_temp2_str = this->thermo_entity_->get_attribute(
-      ha_attr_type::target_temp_low);
-    if (!dest_temp2_str.empty()) {
-      dest_temp2_str = std::to_string(
-        static_cast<int>(std::stof(dest_temp2_str) * 10));
+  if (this->thermo_entity_->has_attribute(ha_attr_type::temperature)) {
+    dest_temp = this->thermo_entity_->get_attribute_number(
+      ha_attr_type::temperature, 0, 1);
+  } else {
+    dest_temp = this->thermo_entity_->get_attribute_number(
+      ha_attr_type::target_temp_high, 0, 1);
+    if (this->thermo_entity_->has_attribute(ha_attr_type::target_temp_low)) {
+      append_number(dest_temp2_str, this->thermo_entity_->get_attribute_number(
+        ha_attr_type::target_temp_low, 0, 1));
     }
   }
-  dest_temp_str = std::to_string(
-    static_cast<int>(std::stof(dest_temp_str) * 10));
 
-  buffer.append(dest_temp_str).append(1, SEPARATOR);
+  append_number(buffer, dest_temp).append(1, SEPARATOR);
 
   auto hvac_action = this->thermo_entity_->get_attribute(
     ha_attr_type::hvac_action);
@@ -290,47 +295,43 @@ std::string &ThermoCard::render(std::string &buffer) {
       .append("\r\n(");
   }
   // backend.component.climate.state
-  buffer.append(get_translation(this->thermo_entity_->get_state()));
+  buffer.append(this->thermo_entity_->get_state_translation());
   if (!hvac_action.empty()) {
     buffer.append(1, ')');
   }
   buffer.append(1, SEPARATOR);
 
-  buffer.append(std::to_string(static_cast<int>(
-    std::stof(this->thermo_entity_->get_attribute(
-      ha_attr_type::min_temp, "0")) * 10)));
+  append_number(buffer, this->thermo_entity_->get_attribute_number(
+    ha_attr_type::min_temp, 0, 1));
   buffer.append(1, SEPARATOR);
 
-  buffer.append(std::to_string(static_cast<int>(
-    std::stof(this->thermo_entity_->get_attribute(
-      ha_attr_type::max_temp, "0")) * 10)));
+  append_number(buffer, this->thermo_entity_->get_attribute_number(
+    ha_attr_type::max_temp, 0, 1));
   buffer.append(1, SEPARATOR);
 
-  buffer.append(std::to_string(static_cast<int>(
-    std::stof(this->thermo_entity_->get_attribute(
-      ha_attr_type::target_temp_step, "0.5")) * 10)));
+  append_number(buffer, this->thermo_entity_->get_attribute_number(
+    ha_attr_type::target_temp_step, 5, 1));
   
   //TODO: add overwrite_supported_modes
-  auto& hvac_modes_str = 
-    this->thermo_entity_->get_attribute(ha_attr_type::hvac_modes);
-  if (hvac_modes_str.empty()) {
+  auto &hvac_modes =
+    this->thermo_entity_->get_attribute_list(ha_attr_type::hvac_modes);
+  if (hvac_modes.empty()) {
     buffer.append(4 * 8, SEPARATOR);
   } else {
-    std::vector<std::string> hvac_modes;
-    hvac_modes.reserve(6);
-    split_str(',', hvac_modes_str, hvac_modes);
-
-    for (auto& mode : hvac_modes) {
+    // the card has room for 8 modes
+    uint16_t mode_count = std::min<uint16_t>(hvac_modes.size(), 8);
+    for (uint16_t i = 0; i < mode_count; i++) {
+      auto mode = hvac_modes.at(i);
       uint16_t active_colour = 64512U; //dark orange
-      if (mode == entity_state::auto_ ||
-          mode == entity_state::heat_cool) {
+      if (str_equal(mode, entity_state::auto_) ||
+          str_equal(mode, entity_state::heat_cool)) {
         active_colour = 1024U; //dark green
-      } else if (mode == entity_state::off ||
-          mode == entity_state::fan_only) {
+      } else if (str_equal(mode, entity_state::off) ||
+          str_equal(mode, entity_state::fan_only)) {
         active_colour = 52857U; // light grey (was: muddy grey|35921)
-      } else if (mode == entity_state::cool) {
+      } else if (str_equal(mode, entity_state::cool)) {
         active_colour = 11487U; //light blue
-      } else if (mode == entity_state::dry) {
+      } else if (str_equal(mode, entity_state::dry)) {
         active_colour = 60897U; //light orange
       }
       buffer.append(1, SEPARATOR);
@@ -342,7 +343,7 @@ std::string &ThermoCard::render(std::string &buffer) {
     }
     
     // todo: disperse icons evenly based on size of hvac_modes
-    buffer.append(4 * (8 - hvac_modes.size()), SEPARATOR);
+    buffer.append(4 * (8 - mode_count), SEPARATOR);
   }
 
   buffer.append(1, SEPARATOR);
@@ -373,7 +374,8 @@ MediaCard::MediaCard(const std::string &uuid,
     const std::shared_ptr<Entity> &media_entity) :
     Card(page_type::cardMedia, uuid),
     media_entity_(media_entity) {
-  media_entity->add_subscriber(this);
+  // the card reads the entity when it is rendered
+  media_entity->add_subscriber(this, ha_attr_mask());
 }
 
 MediaCard::MediaCard(const std::string &uuid,
@@ -381,7 +383,8 @@ MediaCard::MediaCard(const std::string &uuid,
     const std::string &title) :
     Card(page_type::cardMedia, uuid, title),
     media_entity_(media_entity) {
-  media_entity->add_subscriber(this);
+  // the card reads the entity when it is rendered
+  media_entity->add_subscriber(this, ha_attr_mask());
 }
 
 MediaCard::MediaCard(const std::string &uuid,
@@ -389,7 +392,8 @@ MediaCard::MediaCard(const std::string &uuid,
     const std::string &title, const uint16_t sleep_timeout) :
     Card(page_type::cardMedia, uuid, title, sleep_timeout),
     media_entity_(media_entity) {
-  media_entity->add_subscriber(this);
+  // the card reads the entity when it is rendered
+  media_entity->add_subscriber(this, ha_attr_mask());
 }
 
 MediaCard::~MediaCard() {
@@ -418,17 +422,17 @@ std::string &MediaCard::render(std::string &buffer) {
     ha_attr_type::media_artist).substr(0, 40));
   buffer.append(2, SEPARATOR);
 
-  buffer.append(std::to_string(
-    static_cast<uint8_t>(std::stof(this->media_entity_->get_attribute(
-      ha_attr_type::volume_level, "0")) * 100.0f)));
+  // volume_level is 0-1
+  append_number(buffer, static_cast<uint8_t>(this->media_entity_->get_attribute_number(
+    ha_attr_type::volume_level, 0, 2)));
   buffer.append(1, SEPARATOR);
 
   auto icon = this->media_entity_->is_state(entity_state::playing)
     ? icon_t::pause : icon_t::play;
   buffer.append(CHAR8_CAST(icon)).append(1, SEPARATOR);
 
-  uint32_t supported_features = value_or_default(this->media_entity_->
-    get_attribute(ha_attr_type::supported_features), 0UL);
+  uint32_t supported_features = this->media_entity_->
+    get_attribute_number(ha_attr_type::supported_features, 0);
 
   // on/off button colour
   if (supported_features & 0b10000000) {
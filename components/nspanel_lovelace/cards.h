@@ -94,8 +94,9 @@ public:
 
   void set_show_keypad(bool show_keypad) { this->show_keypad_ = show_keypad; }
   bool add_arm_button(alarm_arm_action action);
+  Entity *get_entity() const { return this->alarm_entity_.get(); }
 
-  void on_entity_state_change(const std::string &state) override;
+  void on_entity_state_change(const char *state) override;
   void on_entity_attribute_change(ha_attr_type attr, const std::string &value) override;
 
   std::string &render(std::string &buffer) override;
@@ -128,6 +129,7 @@ public:
   void accept(PageVisitor& visitor) override;
 
   void configure_temperature_unit();
+  Entity *get_entity() const { return this->thermo_entity_.get(); }
 
   std::string &render(std::string &buffer) override;
 
@@ -154,6 +156,7 @@ public:
   virtual ~MediaCard();
 
   void accept(PageVisitor& visitor) override;
+  Entity *get_entity() const { return this->media_entity_.get(); }
 
   std::string &render(std::string &buffer) override;
 
@@ -0,0 +1,47 @@
+#include "command_pacer.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// time the TFT needs to parse and apply a frame once it has been received
+static constexpr uint32_t PACING_PROCESSING_MS = 4u;
+// TFT events arriving this long after a send are attributed to that send
+static constexpr uint32_t PACING_OVERLOAD_WINDOW_MS = 250u;
+static constexpr uint32_t PACING_BACKOFF_MIN_MS = 8u;
+// number of frames sent without overload before the backoff is halved
+static constexpr uint8_t PACING_RECOVERY_FRAMES = 8u;
+
+void CommandPacer::on_sent(uint32_t now, size_t frame_length, uint32_t baud_rate) {
+  this->last_sent_ = now;
+  if (this->policy_ == command_pacing_t::fixed || baud_rate == 0) {
+    this->gap_ = COMMAND_COOLDOWN;
+    return;
+  }
+
+  if (this->backoff_ > 0 && ++this->clean_frames_ >= PACING_RECOVERY_FRAMES) {
+    this->backoff_ /= 2;
+    if (this->backoff_ < PACING_BACKOFF_MIN_MS) this->backoff_ = 0;
+    this->clean_frames_ = 0;
+  }
+
+  // 10 bits per byte on the wire (8N1), rounded up
+  uint32_t wire_ms = ((frame_length * 10000u) + baud_rate - 1) / baud_rate;
+  this->gap_ = wire_ms + PACING_PROCESSING_MS + this->backoff_;
+}
+
+void CommandPacer::on_overload(uint32_t now) {
+  if (this->policy_ != command_pacing_t::adaptive) return;
+  if ((now - this->last_sent_) > PACING_OVERLOAD_WINDOW_MS) return;
+
+  this->overload_count_++;
+  this->clean_frames_ = 0;
+  this->backoff_ = this->backoff_ == 0
+    ? PACING_BACKOFF_MIN_MS
+    : std::min<uint32_t>(this->backoff_ * 2, COMMAND_COOLDOWN);
+  this->gap_ = std::max(this->gap_, this->backoff_);
+}
+
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// Decides when the next display command may be sent.
+//
+// fixed:    always wait COMMAND_COOLDOWN between frames (original behaviour).
+// adaptive: wait for the frame to be transmitted at the current baud rate plus
+//           a small processing margin, and back off (up to COMMAND_COOLDOWN)
+//           when the TFT shows signs of not keeping up shortly after a send.
+class CommandPacer {
+public:
+  void set_policy(command_pacing_t policy) { this->policy_ = policy; }
+  command_pacing_t get_policy() const { return this->policy_; }
+
+  bool is_ready(uint32_t now) const { return (now - this->last_sent_) > this->gap_; }
+  void on_sent(uint32_t now, size_t frame_length, uint32_t baud_rate);
+  // Whether a frame was sent since the given time (within the last ~49 days)
+  bool has_sent_since(uint32_t since, uint32_t now) const { return (now - this->last_sent_) <= (now - since); }
+  // Corrupt or repeated events were received from the TFT
+  void on_overload(uint32_t now);
+
+  uint32_t get_gap() const { return this->gap_; }
+  uint32_t get_backoff() const { return this->backoff_; }
+  uint32_t get_overload_count() const { return this->overload_count_; }
+
+protected:
+  command_pacing_t policy_ = command_pacing_t::fixed;
+  uint32_t last_sent_ = 0;
+  uint32_t gap_ = COMMAND_COOLDOWN;
+  uint32_t backoff_ = 0;
+  uint8_t clean_frames_ = 0;
+  uint32_t overload_count_ = 0;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
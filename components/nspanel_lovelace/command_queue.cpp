@@ -0,0 +1,283 @@
+#include "command_queue.h"
+
+#include <algorithm>
+#include <cstring>
+#include "config.h"
+#include "helpers.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// FNV-1 over a range of the command, avoids creating a substring
+static uint32_t hash_range_(const char *data, size_t length) {
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < length; i++) {
+    hash *= 16777619UL;
+    hash ^= static_cast<uint8_t>(data[i]);
+  }
+  return hash;
+}
+
+static bool is_instruction_(const std::string &command, size_t length, const char *instruction) {
+  return length == std::strlen(instruction) &&
+    command.compare(0, length, instruction) == 0;
+}
+
+command_key get_command_key(const std::string &command) {
+  auto pos = command.find(SEPARATOR);
+  auto length = pos == std::string::npos ? command.length() : pos;
+
+  if (is_instruction_(command, length, "entityUpdateDetail") ||
+      is_instruction_(command, length, "entityUpdateDetail2")) {
+    // the popup the detail is for is the 1st parameter
+    size_t start = length + 1, end = start;
+    if (start < command.length()) {
+      end = command.find(SEPARATOR, start);
+      if (end == std::string::npos) end = command.length();
+    }
+    return {
+      length == 18 ? command_kind::entity_update_detail : command_kind::entity_update_detail2,
+      hash_range_(command.data() + start, end - start) };
+  }
+  if (is_instruction_(command, length, "entityUpd") ||
+      is_instruction_(command, length, "weatherUpdate"))
+    return { command_kind::page_update, 0 };
+  if (is_instruction_(command, length, "pageType"))
+    return { command_kind::page_type, 0 };
+  if (is_instruction_(command, length, "statusUpdate"))
+    return { command_kind::status_update, 0 };
+  if (is_instruction_(command, length, "timeout"))
+    return { command_kind::timeout, 0 };
+  if (is_instruction_(command, length, "dimmode"))
+    return { command_kind::dimmode, 0 };
+  if (is_instruction_(command, length, "time"))
+    return { command_kind::time, 0 };
+  if (is_instruction_(command, length, "date"))
+    return { command_kind::date, 0 };
+  if (is_instruction_(command, length, "notify"))
+    return { command_kind::notify, 0 };
+  return { command_kind::other, 0 };
+}
+
+bool is_page_content(command_kind kind) {
+  return kind == command_kind::page_update ||
+    kind == command_kind::status_update ||
+    kind == command_kind::entity_update_detail ||
+    kind == command_kind::entity_update_detail2;
+}
+
+FramePool::~FramePool() {
+  if (this->data_ != nullptr) SpiRamAllocator().deallocate(this->data_);
+}
+
+void FramePool::set_slot_size(uint16_t slot_size) {
+  if (this->allocated_) return;
+  this->slot_size_ = std::min(slot_size, MAX_SLOT_SIZE);
+}
+
+void FramePool::allocate_() {
+  this->allocated_ = true;
+  // a handful of frames is plenty when the pool has to use internal RAM,
+  // PSRAM is plentiful so any frame up to MAX_SLOT_SIZE gets a slot there
+  if (psram_available()) {
+    this->slot_count_ = 24;
+    this->slot_size_ = MAX_SLOT_SIZE;
+  } else {
+    this->slot_count_ = 8;
+  }
+  this->data_ = static_cast<uint8_t *>(
+    SpiRamAllocator().allocate(this->slot_count_ * this->slot_size_));
+  if (this->data_ == nullptr) this->slot_count_ = 0;
+}
+
+int8_t FramePool::acquire() {
+  if (!this->allocated_) this->allocate_();
+  for (uint8_t i = 0; i < this->slot_count_; i++) {
+    if (this->used_ & (1UL << i)) continue;
+    this->used_ |= (1UL << i);
+    return i;
+  }
+  return -1;
+}
+
+void FramePool::release(int8_t slot) {
+  if (slot < 0) return;
+  this->used_ &= ~(1UL << slot);
+}
+
+uint8_t FramePool::get_used_count() const {
+  return __builtin_popcount(this->used_);
+}
+
+// Writes the complete frame for 'payload' to 'frame', returns the frame length
+static uint16_t encode_frame_(uint8_t *frame, const std::string &payload) {
+  auto length = payload.length();
+  frame[0] = 0x55;
+  frame[1] = 0xBB;
+  frame[2] = static_cast<uint8_t>(length & 0xFF);
+  frame[3] = static_cast<uint8_t>((length >> 8) & 0xFF);
+  std::memcpy(&frame[4], payload.data(), length);
+  // crc covers the header, length and payload
+  auto crc = esphome::crc16(frame, length + 4);
+  frame[length + 4] = static_cast<uint8_t>(crc & 0xFF);
+  frame[length + 5] = static_cast<uint8_t>((crc >> 8) & 0xFF);
+  return length + 6;
+}
+
+void CommandQueue::store_(entry &e, const std::string &command) {
+  size_t length = command.length() + 6;
+  if (length > this->pool_.get_slot_size()) {
+    this->pool_.release(e.slot);
+    e.slot = -1;
+  } else if (e.slot < 0) {
+    e.slot = this->pool_.acquire();
+  }
+
+  uint8_t *frame;
+  if (e.slot < 0) {
+    this->overflow_count_++;
+    e.overflow.resize(length);
+    frame = e.overflow.data();
+  } else {
+    std::vector<uint8_t>().swap(e.overflow);
+    frame = this->pool_.get(e.slot);
+  }
+  e.length = encode_frame_(frame, command);
+}
+
+void CommandQueue::set_max_frame_length(size_t length) {
+  // a bit of headroom for states and names that are longer than the current ones
+  length += length / 2;
+  // multiple of 32 bytes, at least 256 for popup details
+  length = (length + 31) & ~size_t{31};
+  this->pool_.set_slot_size(std::max<size_t>(std::min<size_t>(length, FramePool::MAX_SLOT_SIZE), 256));
+}
+
+void CommandQueue::release_(entry &e) {
+  this->pool_.release(e.slot);
+  e.slot = -1;
+}
+
+bool CommandQueue::push(const std::string &command, command_priority priority, uint32_t now) {
+  auto key = get_command_key(command);
+  auto lane = static_cast<uint8_t>(priority);
+  bool superseded = false;
+
+  if (key.kind == command_kind::page_type) {
+    // content queued for the previous page is stale once a new page is requested
+    for (auto &entries : this->lanes_) {
+      auto it = std::remove_if(entries.begin(), entries.end(),
+        [this](entry &e) {
+          if (!is_page_content(e.key.kind)) return false;
+          this->release_(e);
+          return true;
+        });
+      superseded = superseded || it != entries.end();
+      entries.erase(it, entries.end());
+    }
+  }
+
+  if (key.kind != command_kind::other) {
+    for (uint8_t i = 0; i < LANE_COUNT; i++) {
+      auto &entries = this->lanes_[i];
+      for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (!(it->key == key)) continue;
+        if (i <= lane) {
+          this->store_(*it, command);
+          return true;
+        }
+        // promote to the higher priority lane, keeping the original age
+        entry e = std::move(*it);
+        entries.erase(it);
+        this->store_(e, command);
+        this->lanes_[lane].push_back(std::move(e));
+        return true;
+      }
+    }
+  }
+
+  entry e{key, now, -1, 0, {}};
+  this->store_(e, command);
+  this->lanes_[lane].push_back(std::move(e));
+  return superseded;
+}
+
+bool CommandQueue::pop(const uint8_t *&frame, size_t &length, uint32_t now, uint32_t *queued_at) {
+  std::deque<entry> *next = nullptr;
+  // serve a lower priority command that has waited too long
+  uint32_t max_wait = COMMAND_STARVATION_TIMEOUT;
+  for (uint8_t i = 1; i < LANE_COUNT; i++) {
+    auto &entries = this->lanes_[i];
+    if (entries.empty()) continue;
+    uint32_t wait = now - entries.front().queued_at;
+    if (wait > max_wait) {
+      max_wait = wait;
+      next = &entries;
+    }
+  }
+  if (next == nullptr) {
+    for (auto &entries : this->lanes_) {
+      if (entries.empty()) continue;
+      next = &entries;
+      break;
+    }
+  }
+  if (next == nullptr) return false;
+
+  auto it = next->begin();
+  if (is_page_content(it->key.kind)) {
+    // page content is always queued after the pageType of its page, but may sit
+    // in a higher priority lane: send the pageType first so the TFT never gets
+    // content for a page it hasn't switched to yet
+    for (auto &entries : this->lanes_) {
+      auto page_type = std::find_if(entries.begin(), entries.end(),
+        [](const entry &e) { return e.key.kind == command_kind::page_type; });
+      if (page_type == entries.end()) continue;
+      next = &entries;
+      it = page_type;
+      break;
+    }
+  }
+
+  auto &e = *it;
+  length = e.length;
+  if (queued_at != nullptr) *queued_at = e.queued_at;
+  if (e.slot < 0) {
+    this->sending_.swap(e.overflow);
+    frame = this->sending_.data();
+  } else {
+    // the slot is free for reuse but its content is untouched until the next push
+    frame = this->pool_.get(e.slot);
+    this->release_(e);
+  }
+  next->erase(it);
+  return true;
+}
+
+bool CommandQueue::empty() const {
+  for (auto &entries : this->lanes_) {
+    if (!entries.empty()) return false;
+  }
+  return true;
+}
+
+size_t CommandQueue::size() const {
+  size_t size = 0;
+  for (auto &entries : this->lanes_) {
+    size += entries.size();
+  }
+  return size;
+}
+
+void CommandQueue::clear() {
+  for (auto &entries : this->lanes_) {
+    for (auto &e : entries) {
+      this->release_(e);
+    }
+    entries.clear();
+  }
+}
+
+}
+}
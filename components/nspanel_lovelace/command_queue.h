@@ -0,0 +1,129 @@
+#pragma once
+
+#include <deque>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// What a display command updates on the TFT,
+// a newer command with the same kind (and target) makes an older one stale.
+enum class command_kind : uint8_t {
+  other,                // never superseded
+  page_type,            // pageType~
+  page_update,          // entityUpd~ / weatherUpdate~ (content of the current page)
+  status_update,        // statusUpdate~
+  entity_update_detail, // entityUpdateDetail~{internal_id}~ (popup pages)
+  entity_update_detail2,// entityUpdateDetail2~{internal_id}~
+  timeout,              // timeout~
+  dimmode,              // dimmode~
+  time,                 // time~
+  date,                 // date~
+  notify                // notify~
+};
+
+struct command_key {
+  command_kind kind;
+  // hash of the internal id for popup commands, 0 otherwise
+  uint32_t target;
+
+  bool operator==(const command_key &other) const {
+    return this->kind == other.kind && this->target == other.target;
+  }
+};
+
+// Lanes for outgoing commands, served in strict priority order
+enum class command_priority : uint8_t {
+  interactive, // responses to events from the TFT (button presses, popups)
+  page,        // page content updates
+  background   // screensaver clock, weather etc.
+};
+
+command_key get_command_key(const std::string &command);
+// Content of the current page (or its popups), replaced when the page changes
+bool is_page_content(command_kind kind);
+
+// Fixed set of preallocated frame buffers (in PSRAM when available), so
+// queued commands don't churn and fragment the heap.
+class FramePool {
+public:
+  static constexpr uint16_t MAX_SLOT_SIZE = 512u;
+
+  ~FramePool();
+  // Size of the slots when the pool has to use internal RAM,
+  // only has an effect before the first acquire()
+  void set_slot_size(uint16_t slot_size);
+  // Returns a free slot, -1 if all slots are in use
+  int8_t acquire();
+  void release(int8_t slot);
+  uint8_t *get(int8_t slot) { return &this->data_[slot * this->slot_size_]; }
+
+  uint16_t get_slot_size() const { return this->slot_size_; }
+  uint8_t get_slot_count() const { return this->slot_count_; }
+  uint8_t get_used_count() const;
+
+protected:
+  void allocate_();
+
+  uint8_t *data_ = nullptr;
+  bool allocated_ = false;
+  uint16_t slot_size_ = MAX_SLOT_SIZE;
+  uint8_t slot_count_ = 0;
+  // bit per slot, set when in use
+  uint32_t used_ = 0;
+};
+
+// Queue of outgoing display commands where a newer command with the same key
+// replaces the queued one in place (keeping its position), so the TFT is never
+// sent states that are already outdated.
+// Commands are held in priority lanes, a lower priority command is only sent
+// first when it has been waiting for longer than COMMAND_STARVATION_TIMEOUT.
+// Page switch ordering: a pageType drops all queued page content, and page
+// content is never sent while a pageType is still queued in any lane.
+// Each command is stored as a complete frame (header, payload, crc16) ready to
+// be written to the UART in one go.
+class CommandQueue {
+public:
+  // Returns true if an already queued command was superseded
+  bool push(const std::string &command, command_priority priority, uint32_t now);
+  // Returns the next frame to send, which stays valid until the next call to push(),
+  // returns false if the queue is empty
+  bool pop(const uint8_t *&frame, size_t &length, uint32_t now, uint32_t *queued_at = nullptr);
+
+  bool empty() const;
+  size_t size() const;
+  void clear();
+
+  const FramePool &get_pool() const { return this->pool_; }
+  // Sizes the frame slots for the largest expected frame (see FramePool::set_slot_size)
+  void set_max_frame_length(size_t length);
+  // Number of frames that had to be allocated on the heap
+  uint32_t get_overflow_count() const { return this->overflow_count_; }
+
+protected:
+  static constexpr uint8_t LANE_COUNT = 3;
+
+  struct entry {
+    command_key key;
+    uint32_t queued_at;
+    int8_t slot;
+    uint16_t length;
+    // only used when the frame is too big for a slot or the pool is exhausted
+    std::vector<uint8_t> overflow;
+  };
+
+  void store_(entry &e, const std::string &command);
+  void release_(entry &e);
+
+  std::deque<entry> lanes_[LANE_COUNT];
+  FramePool pool_;
+  // keeps a popped overflow frame alive until it has been sent
+  std::vector<uint8_t> sending_;
+  uint32_t overflow_count_ = 0;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
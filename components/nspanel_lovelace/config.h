@@ -11,10 +11,30 @@ namespace nspanel_lovelace {
 
 enum class temperature_unit_t : uint8_t { celcius, fahrenheit };
 enum class nspanel_model_t : uint8_t { unknown, eu, us_l, us_p };
+enum class command_pacing_t : uint8_t { fixed, adaptive };
 
 constexpr char SEPARATOR = '~';
 // workaround for https://github.com/sairon/esphome-nspanel-lovelace-ui/issues/8
 constexpr uint8_t COMMAND_COOLDOWN = 75u;
+// time after which a lower priority display command is sent ahead of higher priority ones
+constexpr uint16_t COMMAND_STARVATION_TIMEOUT = 1000u;
+// time after which a partially received TFT frame is abandoned (a full frame takes <50ms at 115200 baud)
+constexpr uint8_t TFT_FRAME_TIMEOUT = 100u;
+// number of receive errors within HIGH_BAUD_ERROR_WINDOW after which the high baud rate is abandoned
+constexpr uint8_t HIGH_BAUD_ERROR_LIMIT = 3u;
+constexpr uint16_t HIGH_BAUD_ERROR_WINDOW = 10000u;
+// controls whose repeated events are coalesced at the same time
+constexpr uint8_t BUTTON_COALESCE_SLOTS = 4u;
+// interval between handling repeated events of a control, follows the HA round trip time
+constexpr uint16_t BUTTON_COALESCE_DEFAULT_INTERVAL = 200u;
+constexpr uint16_t BUTTON_COALESCE_MIN_INTERVAL = 100u;
+constexpr uint16_t BUTTON_COALESCE_MAX_INTERVAL = 1000u;
+// display updates per second for entity changes (render_frame_rate)
+constexpr uint8_t RENDER_DEFAULT_FRAME_RATE = 5u;
+// time given to the rest of a burst of entity updates before a frame starts
+constexpr uint8_t RENDER_FRAME_SETTLE = 20u;
+// time between publishing the latency sensors
+constexpr uint32_t LATENCY_PUBLISH_INTERVAL = 60000u;
 constexpr uint16_t DEFAULT_SLEEP_TIMEOUT_S = 20u;
 // Change this value when the state object structure changes
 constexpr uint32_t RESTORE_STATE_VERSION = 0xA62E0210;
@@ -0,0 +1,59 @@
+#include "display_shadow.h"
+
+#include <algorithm>
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+static bool is_shadowed_(command_kind kind) {
+  return kind == command_kind::page_type ||
+    kind == command_kind::timeout ||
+    kind == command_kind::dimmode ||
+    is_page_content(kind);
+}
+
+bool DisplayShadow::update(const std::string &command) {
+  auto key = get_command_key(command);
+  if (!is_shadowed_(key.kind)) return true;
+
+  if (!this->update_(key, esphome::fnv1_hash(command))) {
+    this->skipped_count_++;
+    return false;
+  }
+  // the new page starts out without content
+  if (key.kind == command_kind::page_type) this->forget_(false);
+  return true;
+}
+
+bool DisplayShadow::update_(const command_key &key, uint32_t hash) {
+  for (auto &e : this->entries_) {
+    if (!(e.key == key)) continue;
+    if (e.hash == hash) return false;
+    e.hash = hash;
+    return true;
+  }
+  this->entries_.push_back({key, hash});
+  return true;
+}
+
+void DisplayShadow::forget_(bool page_type) {
+  this->entries_.erase(
+    std::remove_if(this->entries_.begin(), this->entries_.end(),
+      [page_type](const entry &e) {
+        return is_page_content(e.key.kind) ||
+          (page_type && e.key.kind == command_kind::page_type);
+      }),
+    this->entries_.end());
+}
+
+void DisplayShadow::invalidate_page() {
+  this->forget_(true);
+}
+
+void DisplayShadow::invalidate() {
+  this->entries_.clear();
+}
+
+}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "command_queue.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// Keeps track of what the TFT is currently showing (as far as the commands sent
+// to it go), so commands that wouldn't change anything can be skipped.
+//
+// The TFT changes its own content when the user interacts with it (toggles,
+// sliders, opening popups), so the page and its content are forgotten whenever
+// an event arrives from it. Only the whole state is forgotten when it restarts.
+class DisplayShadow {
+public:
+  // Records the command, returns false if the TFT already shows its content
+  bool update(const std::string &command);
+
+  // The TFT may have changed the page or its content by itself
+  void invalidate_page();
+  // The TFT has been reset
+  void invalidate();
+
+  uint32_t get_skipped_count() const { return this->skipped_count_; }
+
+protected:
+  struct entry {
+    command_key key;
+    uint32_t hash;
+  };
+
+  bool update_(const command_key &key, uint32_t hash);
+  // Forgets the content of the page, and the page itself if 'page_type' is set
+  void forget_(bool page_type);
+
+  // latest pageType, timeout and dimmode as well as the content of the
+  // current page and its popups
+  std::vector<entry> entries_;
+  uint32_t skipped_count_ = 0;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
@@ -1,33 +1,40 @@
 #include "entity.h"
 
+#include <algorithm>
+#include "translations.h"
+
 namespace esphome {
 namespace nspanel_lovelace {
 
 Entity::Entity(const std::string &entity_id) :
-    state_(entity_state::unknown) {
+    state_(entity_state::unknown),
+    state_translation_(get_translation(entity_state::unknown)) {
   assert(!entity_id.empty());
   this->set_entity_id(entity_id);
   enable_notifications_ = true;
 }
 Entity::Entity(const std::string &entity_id, const char *type) : 
     type_(type), type_overridden_(true),
-    state_(entity_state::unknown) {
+    state_(entity_state::unknown),
+    state_translation_(get_translation(entity_state::unknown)) {
   assert(!entity_id.empty() && type != nullptr);
   this->set_entity_id(entity_id);
   enable_notifications_ = true;
 }
 
-void Entity::add_subscriber(IEntitySubscriber *const target) {
+void Entity::add_subscriber(IEntitySubscriber *const target, ha_attr_mask_t attributes) {
   // for (auto t : this->targets_) {
   //     if (t == target) return;
   // }
-  this->targets_.push_back(target);
+  this->targets_.push_back({target, attributes});
+  this->subscribed_attributes_ |= attributes;
 }
 
 bool Entity::remove_subscriber(const IEntitySubscriber *const target) {
   for (auto iter = this->targets_.begin(); iter != this->targets_.end(); ++iter) {
-    if (*iter == target) {
+    if (iter->target == target) {
       this->targets_.erase(iter);
+      this->update_subscribed_attributes_();
       return true;
     }
   }
@@ -37,6 +44,21 @@ bool Entity::remove_subscriber(const IEntitySubscriber *const target) {
   return false;
 }
 
+void Entity::set_subscriber_attributes(
+    const IEntitySubscriber *const target, ha_attr_mask_t attributes) {
+  for (auto &s : this->targets_) {
+    if (s.target == target) s.attributes = attributes;
+  }
+  this->update_subscribed_attributes_();
+}
+
+void Entity::update_subscribed_attributes_() {
+  this->subscribed_attributes_ = 0;
+  for (auto &s : this->targets_) {
+    this->subscribed_attributes_ |= s.attributes;
+  }
+}
+
 const std::string &Entity::get_entity_id() const { return this->entity_id_; }
 
 void Entity::set_entity_id(const std::string &entity_id) {
@@ -82,94 +104,322 @@ bool Entity::set_type(const char *type) {
   return true;
 }
 
-bool Entity::is_state(const std::string &state) const { return this->state_ == state; }
+// States that are shared between entities instead of being stored per entity, sorted
+static constexpr const char *KNOWN_STATES[] = {
+  entity_state::above_horizon,
+  entity_state::active,
+  entity_state::armed_away,
+  entity_state::armed_custom_bypass,
+  entity_state::armed_home,
+  entity_state::armed_night,
+  entity_state::armed_vacation,
+  entity_state::arming,
+  entity_state::auto_,
+  entity_state::below_horizon,
+  weather_type::clear_night,
+  entity_state::closed,
+  weather_type::cloudy,
+  entity_state::cool,
+  entity_state::disarmed,
+  entity_state::docked,
+  entity_state::dry,
+  weather_type::exceptional,
+  entity_state::fan_only,
+  weather_type::fog,
+  weather_type::hail,
+  entity_state::heat,
+  entity_state::heat_cool,
+  entity_state::home,
+  entity_state::idle,
+  weather_type::lightning,
+  weather_type::lightning_rainy,
+  entity_state::locked,
+  entity_state::not_home,
+  entity_state::off,
+  entity_state::on,
+  entity_state::open,
+  weather_type::partlycloudy,
+  entity_state::paused,
+  entity_state::pending,
+  entity_state::playing,
+  weather_type::pouring,
+  weather_type::rainy,
+  weather_type::snowy,
+  weather_type::snowy_rainy,
+  weather_type::sunny,
+  entity_state::triggered,
+  entity_state::unavailable,
+  entity_state::unknown,
+  entity_state::unlocked,
+  weather_type::windy,
+  weather_type::windy_variant,
+};
+
+static constexpr bool known_states_sorted_(const char *const *states, size_t count) {
+  return count < 2 || (str_less(states[0], states[1]) &&
+    known_states_sorted_(states + 1, count - 1));
+}
+
+// Returns the constant for a known state, nullptr for free-form states
+static const char *intern_state_(const std::string &state) {
+  static_assert(known_states_sorted_(KNOWN_STATES, sizeof(KNOWN_STATES) / sizeof(*KNOWN_STATES)),
+    "KNOWN_STATES must be sorted");
+  auto end = std::end(KNOWN_STATES);
+  auto it = std::lower_bound(std::begin(KNOWN_STATES), end, state.c_str(),
+    [](const char *a, const char *b) { return str_less(a, b); });
+  if (it == end || state != *it) return nullptr;
+  return *it;
+}
+
+bool Entity::is_state(const char *state) const {
+  if (state == nullptr) return false;
+  if (state == this->state_) return true;
+  return std::strcmp(this->state_, state) == 0;
+}
+
+bool Entity::is_state(const std::string &state) const { return state == this->state_; }
 
-const std::string &Entity::get_state() const { return this->state_; }
+const char *Entity::get_state() const { return this->state_; }
+
+const char *Entity::get_state_translation() const { return this->state_translation_; }
 
 void Entity::set_state(const std::string &state) {
-  if (this->state_ == state) return;
-  this->state_ = state;
+  if (this->is_state(state)) return;
+  auto known_state = intern_state_(state);
+  if (known_state != nullptr) {
+    this->state_ = known_state;
+    this->state_text_.clear();
+  } else {
+    this->state_text_ = state;
+    this->state_ = this->state_text_.c_str();
+  }
+  this->state_translation_ = get_translation(this->state_);
 
   if (this->enable_notifications_) {
-    this->notify_state_change(state);
+    this->notify_state_change(this->state_);
   }
 }
 
+// the attribute bits must fit into a uint64_t
+static_assert(sizeof(ha_attr_names) / sizeof(*ha_attr_names) <= 64, "too many ha_attr_type values");
+
+static constexpr uint64_t attr_bit(ha_attr_type attr) { return 1ULL << static_cast<uint8_t>(attr); }
+
+// Attributes that are also stored as numbers
+static constexpr uint64_t NUMERIC_ATTRIBUTES =
+  attr_bit(ha_attr_type::supported_features) |
+  attr_bit(ha_attr_type::brightness) |
+  attr_bit(ha_attr_type::min_mireds) |
+  attr_bit(ha_attr_type::max_mireds) |
+  attr_bit(ha_attr_type::color_temp) |
+  attr_bit(ha_attr_type::current_position) |
+  attr_bit(ha_attr_type::position) |
+  attr_bit(ha_attr_type::current_tilt_position) |
+  attr_bit(ha_attr_type::tilt_position) |
+  attr_bit(ha_attr_type::temperature) |
+  attr_bit(ha_attr_type::current_temperature) |
+  attr_bit(ha_attr_type::target_temp_high) |
+  attr_bit(ha_attr_type::target_temp_low) |
+  attr_bit(ha_attr_type::target_temp_step) |
+  attr_bit(ha_attr_type::min_temp) |
+  attr_bit(ha_attr_type::max_temp) |
+  attr_bit(ha_attr_type::volume_level) |
+  attr_bit(ha_attr_type::min) |
+  attr_bit(ha_attr_type::max) |
+  attr_bit(ha_attr_type::value) |
+  attr_bit(ha_attr_type::percentage) |
+  attr_bit(ha_attr_type::percentage_step);
+static constexpr uint8_t ATTRIBUTE_DECIMALS = 2;
+// Attributes holding a list of values
+static constexpr uint64_t LIST_ATTRIBUTES =
+  attr_bit(ha_attr_type::supported_color_modes) |
+  attr_bit(ha_attr_type::effect_list) |
+  attr_bit(ha_attr_type::preset_modes) |
+  attr_bit(ha_attr_type::swing_modes) |
+  attr_bit(ha_attr_type::fan_modes) |
+  attr_bit(ha_attr_type::hvac_modes) |
+  attr_bit(ha_attr_type::source_list) |
+  attr_bit(ha_attr_type::options) |
+  attr_bit(ha_attr_type::open_sensors);
+static constexpr int32_t DECIMAL_DIVISORS[ATTRIBUTE_DECIMALS + 1] = {100, 10, 1};
+
 bool Entity::has_attribute(ha_attr_type attr) const {
-  auto it = attributes_.find(attr);
-  return it != attributes_.end();
+  return this->attributes_set_ & attribute_bit_(attr);
 }
 
 const std::string &Entity::get_attribute(ha_attr_type attr, const std::string &default_value) const {
-  auto it = attributes_.find(attr);
-  return it == attributes_.end() ? default_value : it->second;
+  if (!this->has_attribute(attr)) return default_value;
+  return this->attribute_values_[this->attribute_index_(attr)];
+}
+
+int32_t Entity::get_attribute_number(ha_attr_type attr, int32_t default_value, uint8_t decimals) const {
+  if (!(this->numbers_set_ & attribute_bit_(attr))) return default_value;
+  if (decimals > ATTRIBUTE_DECIMALS) decimals = ATTRIBUTE_DECIMALS;
+  return this->number_values_[this->number_index_(attr)] / DECIMAL_DIVISORS[decimals];
+}
+
+uint8_t Entity::number_index_(ha_attr_type attr) const {
+  return __builtin_popcountll(
+    this->attribute_slots_ & NUMERIC_ATTRIBUTES & (attribute_bit_(attr) - 1));
+}
+
+void Entity::set_number_(ha_attr_type attr, const std::string &value) {
+  auto bit = attribute_bit_(attr);
+  if (!(NUMERIC_ATTRIBUTES & bit)) return;
+  if (this->number_values_.empty()) {
+    this->number_values_.resize(
+      __builtin_popcountll(this->attribute_slots_ & NUMERIC_ATTRIBUTES));
+  }
+  if (parse_number(value, this->number_values_[this->number_index_(attr)], ATTRIBUTE_DECIMALS)) {
+    this->numbers_set_ |= bit;
+  } else {
+    this->numbers_set_ &= ~bit;
+  }
+}
+
+void Entity::add_attribute_slot(ha_attr_type attr) {
+  auto bit = attribute_bit_(attr);
+  if (this->attribute_slots_ & bit) return;
+  // the values are only allocated once the first one is set, sized for all the slots
+  if (!this->attribute_values_.empty()) {
+    this->attribute_values_.emplace(
+      this->attribute_values_.begin() + this->attribute_index_(attr));
+  }
+  if ((NUMERIC_ATTRIBUTES & bit) && !this->number_values_.empty()) {
+    this->number_values_.emplace(
+      this->number_values_.begin() + this->number_index_(attr));
+  }
+  if (LIST_ATTRIBUTES & bit) {
+    // slots are added when subscribing, before anything is read, so the lists are
+    // simply parsed again instead of moving them (and their references) around
+    this->lists_.reset();
+    this->lists_parsed_ = 0;
+  }
+  this->attribute_slots_ |= bit;
+}
+
+uint8_t Entity::get_attribute_slot_count() const {
+  return __builtin_popcountll(this->attribute_slots_);
+}
+
+uint8_t Entity::list_index_(ha_attr_type attr) const {
+  return __builtin_popcountll(
+    this->attribute_slots_ & LIST_ATTRIBUTES & (attribute_bit_(attr) - 1));
+}
+
+const AttributeList &Entity::get_attribute_list(ha_attr_type attr) const {
+  static const AttributeList empty_list;
+  auto bit = attribute_bit_(attr);
+  if (!(LIST_ATTRIBUTES & bit) || !this->has_attribute(attr)) return empty_list;
+  if (!this->lists_) {
+    this->lists_.reset(new AttributeList[
+      __builtin_popcountll(this->attribute_slots_ & LIST_ATTRIBUTES)]);
+  }
+  auto &list = this->lists_[this->list_index_(attr)];
+  if (!(this->lists_parsed_ & bit)) {
+    // only the first 14 effects can be rendered
+    list.parse(this->get_attribute(attr), attr == ha_attr_type::effect_list ? 15 : UINT16_MAX);
+    this->lists_parsed_ |= bit;
+  }
+  return list;
+}
+
+void Entity::clear_attribute_list_(ha_attr_type attr) {
+  auto bit = attribute_bit_(attr);
+  if (!(this->lists_parsed_ & bit)) return;
+  this->lists_[this->list_index_(attr)].clear();
+  this->lists_parsed_ &= ~bit;
+}
+
+size_t Entity::get_attribute_memory() const {
+  size_t size = this->attribute_values_.capacity() * sizeof(std::string) +
+    this->number_values_.capacity() * sizeof(int32_t);
+  if (this->lists_) {
+    auto count = __builtin_popcountll(this->attribute_slots_ & LIST_ATTRIBUTES);
+    size += count * sizeof(AttributeList);
+    for (uint8_t i = 0; i < count; i++) {
+      size += this->lists_[i].get_memory();
+    }
+  }
+  for (auto &value : this->attribute_values_) {
+    // short strings are stored inline
+    if (value.capacity() > 15) size += value.capacity() + 1;
+  }
+  return size;
+}
+
+std::string &Entity::attribute_value_(ha_attr_type attr) {
+  if (this->attribute_values_.empty()) {
+    auto count = this->get_attribute_slot_count();
+    this->attribute_values_.reserve(count);
+    this->attribute_values_.resize(count);
+  }
+  return this->attribute_values_[this->attribute_index_(attr)];
 }
 
 void Entity::set_attribute(ha_attr_type attr, const std::string &value) {
   if (value.empty() || value == "None" || value == "none") {
-    attributes_.erase(attr);
+    if (this->has_attribute(attr)) {
+      this->attributes_set_ &= ~attribute_bit_(attr);
+      this->numbers_set_ &= ~attribute_bit_(attr);
+      std::string().swap(this->attribute_value_(attr));
+      this->clear_attribute_list_(attr);
+    }
     this->notify_attribute_change(attr, "");
     return;
   }
-  if (this->attributes_[attr] == value) return;
-
-  if (attr == ha_attr_type::brightness) {
-    this->attributes_[attr] = std::to_string(static_cast<int>(round(
-        scale_value(std::stoi(value), {0, 255}, {0, 100}))));
-  } else if (attr == ha_attr_type::color_temp) {
-    auto &minstr = this->get_attribute(ha_attr_type::min_mireds);
-    auto &maxstr = this->get_attribute(ha_attr_type::max_mireds);
-    uint16_t min_mireds = minstr.empty() ? 153 : std::stoi(minstr);
-    uint16_t max_mireds = maxstr.empty() ? 500 : std::stoi(maxstr);
-    this->attributes_[attr] = std::to_string(static_cast<int>(round(scale_value(
-        std::stoi(value),
+  this->add_attribute_slot(attr);
+  auto &attr_value = this->attribute_value_(attr);
+  if (this->has_attribute(attr) && attr_value == value) return;
+  this->attributes_set_ |= attribute_bit_(attr);
+
+  int32_t number;
+  if (attr == ha_attr_type::brightness && parse_number(value, number)) {
+    attr_value.clear();
+    append_number(attr_value, static_cast<int32_t>(round(
+        scale_value(number, {0, 255}, {0, 100}))));
+  } else if (attr == ha_attr_type::color_temp && parse_number(value, number)) {
+    auto min_mireds = this->get_attribute_number(ha_attr_type::min_mireds, 153);
+    auto max_mireds = this->get_attribute_number(ha_attr_type::max_mireds, 500);
+    attr_value.clear();
+    append_number(attr_value, static_cast<int32_t>(round(scale_value(
+        number,
         {static_cast<double>(min_mireds), static_cast<double>(max_mireds)},
         {0, 100}))));
-  } else if (attr == ha_attr_type::supported_color_modes ||
-      attr == ha_attr_type::effect_list ||
-      attr == ha_attr_type::preset_modes ||
-      attr == ha_attr_type::swing_modes ||
-      attr == ha_attr_type::fan_modes ||
-      attr == ha_attr_type::hvac_modes ||
-      // todo: this list can contain any value (including ones with commas),
-      //       convert_python_arr_str does not support this scenario!
-      attr == ha_attr_type::source_list ||
-      attr == ha_attr_type::options) {
-    // todo: remove this when esphome starts sending properly formatted array strings
-    this->attributes_[attr] = convert_python_arr_str(value);
-    
-    // only store the first 14 effects as additonal ones will never be rendered
-    if (attr == ha_attr_type::effect_list) {
-      auto split_pos = find_nth_of(',', 15, this->attributes_[attr]);
-      if (split_pos != std::string::npos) {
-        this->attributes_[attr] = this->attributes_[attr].substr(0, split_pos);
-      }
-    }
-    this->attributes_[attr].shrink_to_fit();
+  } else if (LIST_ATTRIBUTES & attribute_bit_(attr)) {
+    // parsed by get_attribute_list() when it is needed
+    attr_value = value;
+    attr_value.shrink_to_fit();
+    this->clear_attribute_list_(attr);
   } else {
-    this->attributes_[attr] = value;
+    attr_value = value;
   }
+  this->set_number_(attr, attr_value);
 
   if (this->enable_notifications_) {
-    this->notify_attribute_change(attr, this->attributes_[attr]);
+    this->notify_attribute_change(attr, attr_value);
   }
 }
 
 void Entity::notify_type_change(const char *type) {
   for (auto iter = this->targets_.begin(); iter != this->targets_.end(); ++iter) {
-    (*iter)->on_entity_type_change(type);
+    iter->target->on_entity_type_change(type);
   }
 }
 
-void Entity::notify_state_change(const std::string &state) {
+void Entity::notify_state_change(const char *state) {
+  auto bit = attribute_bit_(ha_attr_type::state);
+  if (!(this->subscribed_attributes_ & bit)) return;
   for (auto iter = this->targets_.begin(); iter != this->targets_.end(); ++iter) {
-    (*iter)->on_entity_state_change(state);
+    if (iter->attributes & bit) iter->target->on_entity_state_change(state);
   }
 }
 
 void Entity::notify_attribute_change(ha_attr_type attr, const std::string &value) {
+  auto bit = attribute_bit_(attr);
+  if (!(this->subscribed_attributes_ & bit)) return;
   for (auto iter = this->targets_.begin(); iter != this->targets_.end(); ++iter) {
-    (*iter)->on_entity_attribute_change(attr, value);
+    if (iter->attributes & bit) iter->target->on_entity_attribute_change(attr, value);
   }
 }
 
@@ -1,21 +1,43 @@
 #pragma once
 
+#include <memory>
 #include <stdint.h>
 #include <string>
-#include <map>
 #include <vector>
 
+#include "attribute_list.h"
 #include "helpers.h"
 #include "types.h"
 
 namespace esphome {
 namespace nspanel_lovelace {
 
+// Index of an entity in the EntityRegistry
+typedef uint16_t entity_handle_t;
+constexpr entity_handle_t INVALID_ENTITY_HANDLE = UINT16_MAX;
+
+// Set of ha_attr_type values, selects the state/attribute notifications a subscriber receives
+typedef uint64_t ha_attr_mask_t;
+constexpr ha_attr_mask_t ALL_HA_ATTRIBUTES = UINT64_MAX;
+
+constexpr ha_attr_mask_t ha_attr_mask() { return 0; }
+template<typename... Attrs>
+constexpr ha_attr_mask_t ha_attr_mask(ha_attr_type attr, Attrs... attrs) {
+  return (1ULL << static_cast<uint8_t>(attr)) | ha_attr_mask(attrs...);
+}
+
+// The state/attributes to subscribe to in Home Assistant for an entity,
+// the table of these is generated from the cards that show the entities
+struct entity_subscription {
+  const char *entity_id;
+  ha_attr_mask_t attributes;
+};
+
 struct IEntitySubscriber {
 public:
   virtual ~IEntitySubscriber() {}
   virtual void on_entity_type_change(const char *type) {}
-  virtual void on_entity_state_change(const std::string &state) {}
+  virtual void on_entity_state_change(const char *state) {}
   virtual void on_entity_attribute_change(ha_attr_type attr, const std::string &value) {}
 };
 
@@ -23,36 +45,99 @@ class Entity {
 public:
   Entity(const std::string &entity_id);
   Entity(const std::string &entity_id, const char *type);
+  // 'state_' may point into the entity itself
+  Entity(const Entity &) = delete;
+  Entity &operator=(const Entity &) = delete;
 
-  void add_subscriber(IEntitySubscriber *const target);
+  // Type changes are always sent, state and attribute changes only when they are in 'attributes'
+  void add_subscriber(IEntitySubscriber *const target, ha_attr_mask_t attributes = ALL_HA_ATTRIBUTES);
   bool remove_subscriber(const IEntitySubscriber *const target);
+  void set_subscriber_attributes(const IEntitySubscriber *const target, ha_attr_mask_t attributes);
 
   const std::string &get_entity_id() const;
   void set_entity_id(const std::string &entity_id);
+
+  entity_handle_t get_handle() const { return this->handle_; }
+  void set_handle(entity_handle_t handle) { this->handle_ = handle; }
   
   bool is_type(const char *type) const;
   const char *get_type() const;
   bool set_type(const char *type);
 
+  // Known states are interned, so a match against the entity_state
+  // constants is a pointer compare
+  bool is_state(const char *state) const;
   bool is_state(const std::string &state) const;
-  const std::string &get_state() const;
+  const char *get_state() const;
+  // The translation of the state, resolved when the state changes
+  const char *get_state_translation() const;
   void set_state(const std::string &state);
 
   bool has_attribute(ha_attr_type attr) const;
   const std::string &get_attribute(ha_attr_type attr, const std::string &default_value = "") const;
   void set_attribute(ha_attr_type attr, const std::string &value);
+  // Numeric attributes are parsed once when they are set, 'decimals' (0-2) selects the
+  // fixed point scale of the value, i.e. 21.55 -> 21, 215 or 2155.
+  // 'default_value' is returned when the attribute isn't set or isn't a number.
+  int32_t get_attribute_number(ha_attr_type attr, int32_t default_value, uint8_t decimals = 0) const;
+  // List attributes (effect_list, source_list, options, ...) are stored as received and only
+  // parsed when they are first read, the parsed list is kept until the attribute changes.
+  // The returned list stays at the same address for the lifetime of the entity (its content
+  // changes with the attribute), unless a list attribute that had no slot is added later.
+  const AttributeList &get_attribute_list(ha_attr_type attr) const;
+  // Reserves storage for an attribute that is expected to be set (i.e. subscribed to),
+  // attributes without a slot get one when they are first set
+  void add_attribute_slot(ha_attr_type attr);
+  uint8_t get_attribute_slot_count() const;
+  // Heap used for the attribute values
+  size_t get_attribute_memory() const;
 
 protected:
   std::string entity_id_;
+  entity_handle_t handle_ = INVALID_ENTITY_HANDLE;
   const char *type_;
   bool type_overridden_ = false;
-  std::string state_;
-  std::map<ha_attr_type, std::string> attributes_;
-  std::vector<IEntitySubscriber*> targets_;
+  // One of the known states (entity_state/weather_type constants),
+  // otherwise points to 'state_text_'
+  const char *state_;
+  const char *state_translation_;
+  // Only free-form states (sensor values, text, ...) are stored
+  std::string state_text_;
+  // Attributes are stored in a flat array with one slot per bit set in 'attribute_slots_',
+  // in the order of the attributes. 'attributes_set_' holds the ones that have a value.
+  uint64_t attribute_slots_ = 0;
+  uint64_t attributes_set_ = 0;
+  std::vector<std::string> attribute_values_;
+  // Parsed values of the numeric attributes with a slot, stored with ATTRIBUTE_DECIMALS
+  // digits after the point. 'numbers_set_' holds the ones that are valid numbers.
+  uint64_t numbers_set_ = 0;
+  std::vector<int32_t> number_values_;
+  // One parsed list per list attribute with a slot, allocated when the first one is read.
+  // 'lists_parsed_' holds the ones that are up to date with their attribute value.
+  mutable std::unique_ptr<AttributeList[]> lists_;
+  mutable uint64_t lists_parsed_ = 0;
+  struct subscriber {
+    IEntitySubscriber *target;
+    ha_attr_mask_t attributes;
+  };
+  std::vector<subscriber> targets_;
+  // Attributes at least one subscriber wants to be notified about
+  ha_attr_mask_t subscribed_attributes_ = 0;
   bool enable_notifications_ = false;
 
+  static uint64_t attribute_bit_(ha_attr_type attr) { return ha_attr_mask(attr); }
+  uint8_t attribute_index_(ha_attr_type attr) const {
+    return __builtin_popcountll(this->attribute_slots_ & (attribute_bit_(attr) - 1));
+  }
+  std::string &attribute_value_(ha_attr_type attr);
+  uint8_t number_index_(ha_attr_type attr) const;
+  uint8_t list_index_(ha_attr_type attr) const;
+  void set_number_(ha_attr_type attr, const std::string &value);
+  void clear_attribute_list_(ha_attr_type attr);
+
+  void update_subscribed_attributes_();
   void notify_type_change(const char *type);
-  void notify_state_change(const std::string &state);
+  void notify_state_change(const char *state);
   void notify_attribute_change(ha_attr_type attr, const std::string &value);
 };
 
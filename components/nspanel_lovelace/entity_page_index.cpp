@@ -0,0 +1,72 @@
+#include "entity_page_index.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+void EntityPageIndex::clear() {
+  this->pending_.clear();
+  this->offsets_.clear();
+  this->pages_.clear();
+  this->status_icon_bits_.clear();
+  this->built_ = false;
+}
+
+void EntityPageIndex::add(entity_handle_t handle, const Page *page) {
+  if (handle == INVALID_ENTITY_HANDLE || page == nullptr) return;
+  this->pending_.emplace_back(handle, page);
+  this->built_ = false;
+}
+
+void EntityPageIndex::add_status_icon(entity_handle_t handle) {
+  if (handle == INVALID_ENTITY_HANDLE) return;
+  size_t word = handle / 32;
+  if (word >= this->status_icon_bits_.size()) this->status_icon_bits_.resize(word + 1);
+  this->status_icon_bits_[word] |= 1UL << (handle % 32);
+}
+
+void EntityPageIndex::build(size_t entity_count) {
+  auto &entries = this->pending_;
+  std::sort(entries.begin(), entries.end());
+  // a page may display the same entity more than once
+  entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+  this->offsets_.assign(entity_count + 1, 0);
+  this->pages_.clear();
+  this->pages_.reserve(entries.size());
+  size_t pos = 0;
+  for (size_t handle = 0; handle < entity_count; handle++) {
+    this->offsets_[handle] = this->pages_.size();
+    for (; pos < entries.size() && entries[pos].first == handle; pos++) {
+      this->pages_.push_back(entries[pos].second);
+    }
+  }
+  this->offsets_[entity_count] = this->pages_.size();
+  this->pages_.shrink_to_fit();
+  std::vector<std::pair<entity_handle_t, const Page *>>().swap(this->pending_);
+  this->built_ = true;
+}
+
+bool EntityPageIndex::is_on_page(entity_handle_t handle, const Page *page) const {
+  if (handle + 1u >= this->offsets_.size()) return false;
+  auto begin = this->pages_.begin() + this->offsets_[handle];
+  auto end = this->pages_.begin() + this->offsets_[handle + 1];
+  return std::find(begin, end, page) != end;
+}
+
+bool EntityPageIndex::is_status_icon(entity_handle_t handle) const {
+  size_t word = handle / 32;
+  return word < this->status_icon_bits_.size() &&
+    (this->status_icon_bits_[word] & (1UL << (handle % 32))) != 0;
+}
+
+size_t EntityPageIndex::get_memory() const {
+  return this->pending_.capacity() * sizeof(this->pending_[0]) +
+    this->offsets_.capacity() * sizeof(uint16_t) +
+    this->pages_.capacity() * sizeof(const Page *) +
+    this->status_icon_bits_.capacity() * sizeof(uint32_t);
+}
+
+}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "entity.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+class Page;
+
+// Maps each entity to the pages that display it and to the screensaver status
+// icons it feeds, so deciding whether a change is visible is a lookup.
+//
+// Entries are collected with add() from the assembled pages, build() then sorts
+// them into one list of pages per entity handle (with the offset of each
+// entity's range) and a bit per entity for the status icons.
+class EntityPageIndex {
+public:
+  void clear();
+  void add(entity_handle_t handle, const Page *page);
+  void add_status_icon(entity_handle_t handle);
+  void build(size_t entity_count);
+  void invalidate() { this->built_ = false; }
+  bool is_built() const { return this->built_; }
+
+  bool is_on_page(entity_handle_t handle, const Page *page) const;
+  bool is_status_icon(entity_handle_t handle) const;
+
+  size_t get_memory() const;
+
+protected:
+  std::vector<std::pair<entity_handle_t, const Page *>> pending_;
+  // pages_[offsets_[handle]..offsets_[handle + 1]] display the entity
+  std::vector<uint16_t> offsets_;
+  std::vector<const Page *> pages_;
+  // one bit per entity handle
+  std::vector<uint32_t> status_icon_bits_;
+  bool built_ = false;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
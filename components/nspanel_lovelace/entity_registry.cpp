@@ -0,0 +1,33 @@
+#include "entity_registry.h"
+
+#include <algorithm>
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+std::shared_ptr<Entity> EntityRegistry::create(const std::string &entity_id) {
+  auto handle = this->find(entity_id);
+  if (handle != INVALID_ENTITY_HANDLE) return this->entities_[handle];
+
+  auto entity = std::make_shared<Entity>(entity_id);
+  entity->set_handle(static_cast<entity_handle_t>(this->entities_.size()));
+  this->entities_.push_back(entity);
+  // entities are only created while the config is set up, keep the index sorted as they are added
+  index_entry e{esphome::fnv1_hash(entity_id), entity->get_handle()};
+  this->index_.insert(std::upper_bound(this->index_.begin(), this->index_.end(), e), e);
+  return entity;
+}
+
+entity_handle_t EntityRegistry::find(const std::string &entity_id) const {
+  index_entry key{esphome::fnv1_hash(entity_id), INVALID_ENTITY_HANDLE};
+  auto it = std::lower_bound(this->index_.begin(), this->index_.end(), key);
+  // entities whose ids share a hash are next to each other
+  for (; it != this->index_.end() && it->hash == key.hash; ++it) {
+    if (this->entities_[it->handle]->get_entity_id() == entity_id) return it->handle;
+  }
+  return INVALID_ENTITY_HANDLE;
+}
+
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "entity.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// Owns the entities and gives each of them a dense handle (its index),
+// entity ids are looked up through an index sorted by their hash.
+class EntityRegistry {
+public:
+  // Returns the entity with the id, creating it if it doesn't exist yet
+  std::shared_ptr<Entity> create(const std::string &entity_id);
+
+  Entity *get(entity_handle_t handle) const {
+    return handle < this->entities_.size() ? this->entities_[handle].get() : nullptr;
+  }
+  Entity *get(const std::string &entity_id) const { return this->get(this->find(entity_id)); }
+  // Returns INVALID_ENTITY_HANDLE if the entity doesn't exist
+  entity_handle_t find(const std::string &entity_id) const;
+
+  const std::vector<std::shared_ptr<Entity>> &get_entities() const { return this->entities_; }
+  size_t size() const { return this->entities_.size(); }
+
+protected:
+  struct index_entry {
+    uint32_t hash;
+    entity_handle_t handle;
+
+    bool operator<(const index_entry &other) const { return this->hash < other.hash; }
+  };
+
+  std::vector<std::shared_ptr<Entity>> entities_;
+  std::vector<index_entry> index_;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
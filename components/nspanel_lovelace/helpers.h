@@ -2,6 +2,7 @@
 
 #include "defines.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
@@ -10,6 +11,7 @@
 #include <esp_heap_caps.h>
 #include <math.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string>
 #include <time.h>
 #include <vector>
@@ -63,14 +65,75 @@ inline const char* value_or_empty(const char* s) {
   return s == nullptr ? "" : s; 
 }
 
+// Parses a decimal number into a fixed point value with 'decimals' digits after the point
+// (further digits are truncated), i.e. "21.55" -> 21, 215 or 2155.
+// Returns false instead of throwing when the text isn't a (32 bit) number.
+inline bool parse_number(const char *str, size_t length, int32_t &value, uint8_t decimals = 0) {
+  size_t i = 0;
+  bool negative = false;
+  if (i < length && (str[i] == '-' || str[i] == '+')) negative = str[i++] == '-';
+  int64_t result = 0;
+  bool has_digits = false;
+  for (; i < length && isdigit(str[i]); i++) {
+    result = result * 10 + (str[i] - '0');
+    if (result > INT32_MAX) return false;
+    has_digits = true;
+  }
+  uint8_t fraction = 0;
+  if (i < length && str[i] == '.') {
+    for (i++; i < length && isdigit(str[i]); i++) {
+      has_digits = true;
+      if (fraction == decimals) continue;
+      result = result * 10 + (str[i] - '0');
+      fraction++;
+    }
+  }
+  if (!has_digits || i != length) return false;
+  for (; fraction < decimals; fraction++) result *= 10;
+  if (result > INT32_MAX) return false;
+  value = static_cast<int32_t>(negative ? -result : result);
+  return true;
+}
+
+inline bool parse_number(const std::string &str, int32_t &value, uint8_t decimals = 0) {
+  return parse_number(str.data(), str.length(), value, decimals);
+}
+
+// Appends the integer without going through snprintf or a temporary string
+inline std::string &append_number(std::string &buffer, int32_t value) {
+  char digits[10];
+  uint32_t n = value < 0 ? 0u - static_cast<uint32_t>(value) : value;
+  uint8_t pos = sizeof(digits);
+  do {
+    digits[--pos] = '0' + n % 10;
+    n /= 10;
+  } while (n > 0);
+  if (value < 0) buffer.append(1, '-');
+  return buffer.append(digits + pos, sizeof(digits) - pos);
+}
+
+// Appends a fixed point value with 'decimals' digits after the point, i.e. (215, 1) -> "21.5"
+inline std::string &append_fixed(std::string &buffer, int32_t value, uint8_t decimals) {
+  if (decimals == 0) return append_number(buffer, value);
+  uint32_t divisor = 1;
+  for (uint8_t i = 0; i < decimals; i++) divisor *= 10;
+  uint32_t n = value < 0 ? 0u - static_cast<uint32_t>(value) : value;
+  if (value < 0) buffer.append(1, '-');
+  append_number(buffer, n / divisor).append(1, '.');
+  // leading zeros of the fraction
+  for (uint32_t d = divisor / 10; d > 1 && (n % divisor) < d; d /= 10) buffer.append(1, '0');
+  return append_number(buffer, n % divisor);
+}
+
+// strtol & co. don't throw on malformed input, unlike std::stoi
 inline unsigned long value_or_default(const std::string &str, unsigned long default_value) {
   return str.empty() || (str[0] != '-' && str[0] != '+' && !isdigit(str[0]))
-    ? default_value : std::stoul(str);
+    ? default_value : strtoul(str.c_str(), nullptr, 10);
 }
 
 inline int value_or_default(const std::string &str, int default_value) {
   return str.empty() || (str[0] != '-' && str[0] != '+' && !isdigit(str[0]))
-    ? default_value : std::stoi(str);
+    ? default_value : static_cast<int>(strtol(str.c_str(), nullptr, 10));
 }
 
 inline unsigned int value_or_default(const std::string &str, unsigned int default_value) {
@@ -79,7 +142,7 @@ inline unsigned int value_or_default(const std::string &str, unsigned int defaul
 
 inline double value_or_default(const std::string &str, double default_value) {
   return str.empty() || (str[0] != '-' && str[0] != '+' && !isdigit(str[0]))
-    ? default_value : std::stod(str);
+    ? default_value : strtod(str.c_str(), nullptr);
 }
 
 inline bool iso8601_to_tm(const char* iso8601_string, tm &t) {
@@ -189,6 +252,34 @@ inline static constexpr bool str_equal(const char *a, const char *b) {
   return a == b || (a != nullptr && b != nullptr && std::strcmp(a, b) == 0);
 }
 
+// strcmp(a, b) < 0 that can be used in constant expressions
+inline static constexpr bool str_less(const char *a, const char *b) {
+  return *a != *b
+    ? static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b)
+    : *a != '\0' && str_less(a + 1, b + 1);
+}
+
+// Whether the entries of a table are sorted by their 'type' (strcmp order)
+template<typename T, size_t N>
+constexpr bool is_sorted_by_type(const T (&table)[N], size_t from = 0) {
+  return from + 1 >= N ||
+    (str_less(table[from].type, table[from + 1].type) && is_sorted_by_type(table, from + 1));
+}
+
+// Binary search in a table sorted by 'type', nullptr if there is no entry for 'type'
+template<typename T>
+const T *find_by_type(const T *table, size_t count, const char *type) {
+  auto end = table + count;
+  auto it = std::lower_bound(table, end, type,
+    [](const T &entry, const char *t) { return str_less(entry.type, t); });
+  return it == end || std::strcmp(it->type, type) != 0 ? nullptr : it;
+}
+
+template<typename T, size_t N>
+const T *find_by_type(const T (&table)[N], const char *type) {
+  return find_by_type(table, N, type);
+}
+
 inline void split_str(char delimiter, const std::string &str, std::vector<std::string> &array, uint16_t max_items = UINT16_MAX) {
   size_t pos_start = 0, pos_end = 0;
   std::string item;
@@ -203,6 +294,47 @@ inline void split_str(char delimiter, const std::string &str, std::vector<std::s
   if (!item.empty()) { array.push_back(str.substr(pos_start)); }
 }
 
+// Non-owning view of a part of a string, the string must outlive it
+struct str_span {
+  const char *data = "";
+  size_t length = 0;
+
+  str_span() = default;
+  str_span(const char *data, size_t length) : data(data), length(length) {}
+  str_span(const std::string &str) : data(str.data()), length(str.length()) {}
+
+  bool empty() const { return this->length == 0; }
+  std::string str() const { return std::string(this->data, this->length); }
+
+  bool operator==(const char *other) const {
+    return std::strlen(other) == this->length &&
+      std::memcmp(this->data, other, this->length) == 0;
+  }
+  bool operator==(const std::string &other) const {
+    return other.length() == this->length &&
+      std::memcmp(this->data, other.data(), this->length) == 0;
+  }
+  bool operator!=(const char *other) const { return !(*this == other); }
+  bool operator!=(const std::string &other) const { return !(*this == other); }
+};
+
+// Same as split_str() above but without copying the items (or allocating),
+// fills at most 'max_items' spans and returns the number of items found.
+inline uint8_t split_str(char delimiter, const std::string &str, str_span *items, uint8_t max_items) {
+  size_t pos_start = 0, pos_end = 0;
+  uint8_t item_count = 0;
+  while (item_count < max_items) {
+    pos_end = str.find(delimiter, pos_start);
+    auto end = pos_end == std::string::npos ? str.length() : pos_end;
+    // empty items are skipped
+    if (end > pos_start)
+      items[item_count++] = str_span(str.data() + pos_start, end - pos_start);
+    if (pos_end == std::string::npos) break;
+    pos_start = pos_end + 1;
+  }
+  return item_count;
+}
+
 inline size_t find_nth_of(char delimiter, uint16_t count, const std::string &str) {
   size_t pos = std::string::npos;
   if (count == 0) return pos;
@@ -216,28 +348,6 @@ inline size_t find_nth_of(char delimiter, uint16_t count, const std::string &str
   return pos;
 }
 
-// Takes the string representation of a Python array (enums, strings etc) and extracts the 
-// values to a new string separated by delimiter.
-// todo: remove this when esphome starts sending properly formatted array strings
-inline std::string convert_python_arr_str(const std::string &str, const char delimiter = ',') {
-  if (str.empty()) return str;
-  size_t pos_start = std::string::npos, pos_end = pos_start;
-  std::string tmp;
-  do {
-      pos_start = str.find('\'', pos_end + 1);
-      if (pos_start == std::string::npos) {
-        if (tmp.back() == delimiter) tmp.pop_back();
-        break;
-      }
-      pos_end = str.find('\'', pos_start + 1);
-      if (pos_end == std::string::npos) break;
-      // ignore empty entries
-      if (pos_end - pos_start - 1 == 0) continue;
-      tmp.append(str.substr(pos_start + 1, pos_end - pos_start - 1)).append(1, delimiter);
-  } while (true);
-  return tmp.empty() ? str : tmp;
-}
-
 inline std::string to_string(const std::vector<std::string> &array, 
     char delimiter = ',', const char prepend_char = '\0', 
     const char append_char = '\0') {
@@ -280,5 +390,29 @@ inline size_t psram_used() {
       heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
 }
 
+// Allocates from PSRAM if available, otherwise uses normal malloc
+struct SpiRamAllocator {
+  void* allocate(size_t size) {
+   if (psram_available())
+     return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+   else
+     return malloc(size);
+  }
+
+  void deallocate(void* pointer) {
+    if (psram_available())
+      heap_caps_free(pointer);
+    else
+      return free(pointer);
+  }
+
+  void* reallocate(void* ptr, size_t new_size) {
+    if (psram_available())
+      return heap_caps_realloc(ptr, new_size, MALLOC_CAP_SPIRAM);
+    else
+      return realloc(ptr, new_size);
+  }
+};
+
 } // namespace nspanel_lovelace
 } // namespace esphome
\ No newline at end of file
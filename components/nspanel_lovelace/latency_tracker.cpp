@@ -0,0 +1,107 @@
+#include "latency_tracker.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+const char *to_string(latency_stage stage) {
+  switch (stage) {
+  case latency_stage::event: return "event";
+  case latency_stage::handler: return "handler";
+  case latency_stage::home_assistant: return "home_assistant";
+  case latency_stage::render: return "render";
+  case latency_stage::display: return "display";
+  case latency_stage::total: return "total";
+  }
+  return "";
+}
+
+const uint16_t LatencyHistogram::BUCKET_LIMITS[BUCKET_COUNT - 1] = {
+  10, 25, 50, 100, 200, 350, 500, 1000, 2000
+};
+
+void LatencyHistogram::record(uint32_t ms) {
+  uint8_t i = 0;
+  while (i < BUCKET_COUNT - 1 && ms > BUCKET_LIMITS[i]) i++;
+  this->buckets_[i]++;
+  this->count_++;
+  this->sum_ += ms;
+  this->max_ = std::max(this->max_, ms);
+}
+
+void LatencyHistogram::clear() {
+  this->buckets_.fill(0);
+  this->count_ = 0;
+  this->max_ = 0;
+  this->sum_ = 0;
+}
+
+uint32_t LatencyHistogram::get_percentile(uint8_t percentile) const {
+  if (this->count_ == 0) return 0;
+  // rank of the sample, rounded up
+  uint32_t rank = (static_cast<uint64_t>(this->count_) * percentile + 99) / 100;
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT - 1; i++) {
+    seen += this->buckets_[i];
+    if (seen >= rank && seen > 0) return std::min<uint32_t>(BUCKET_LIMITS[i], this->max_);
+  }
+  return this->max_;
+}
+
+void LatencyTracker::record_(latency_stage stage, uint32_t ms) {
+  this->histograms_[static_cast<uint8_t>(stage)].record(ms);
+  this->window_[static_cast<uint8_t>(stage)].record(ms);
+}
+
+void LatencyTracker::clear_window() {
+  for (auto &h : this->window_) h.clear();
+}
+
+void LatencyTracker::on_frame(uint32_t now) {
+  this->frame_at_ = now;
+}
+
+void LatencyTracker::on_dispatch(uint32_t received_at, uint32_t now) {
+  this->record_(latency_stage::event, now - received_at);
+  this->started_at_ = received_at;
+  this->dispatched_at_ = now;
+  this->state_ = state_t::dispatched;
+}
+
+void LatencyTracker::on_service_call(const std::string &entity_id, uint32_t now) {
+  if (this->state_ != state_t::dispatched) return;
+  this->record_(latency_stage::handler, now - this->dispatched_at_);
+  this->entity_id_ = entity_id;
+  this->called_at_ = now;
+  this->state_ = state_t::called;
+}
+
+void LatencyTracker::on_state_update(const std::string &entity_id, uint32_t now) {
+  if (this->state_ != state_t::called || entity_id != this->entity_id_) return;
+  this->record_(latency_stage::home_assistant, now - this->called_at_);
+  this->updated_at_ = now;
+  this->state_ = state_t::updated;
+}
+
+void LatencyTracker::on_render(uint32_t now) {
+  if (this->state_ != state_t::updated) return;
+  this->record_(latency_stage::render, now - this->updated_at_);
+  this->rendered_at_ = now;
+  this->state_ = state_t::rendered;
+}
+
+void LatencyTracker::on_frame_sent(uint32_t now) {
+  if (this->state_ == state_t::rendered) {
+    this->record_(latency_stage::display, now - this->rendered_at_);
+  } else if (this->state_ != state_t::dispatched) {
+    // still waiting for Home Assistant
+    return;
+  }
+  // interactions that don't call HA (navigation, popups) are answered straight away
+  this->record_(latency_stage::total, now - this->started_at_);
+  this->state_ = state_t::idle;
+}
+
+}
+}
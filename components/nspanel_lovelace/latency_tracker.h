@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <string>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// Stages of an interaction with the TFT, from the event it sends to the response
+enum class latency_stage : uint8_t {
+  event,          // event frame received -> button press dispatched (includes coalescing)
+  handler,        // button press dispatched -> HA service called
+  home_assistant, // HA service called -> entity update received
+  render,         // entity update received -> page re-rendered (includes the update timeout)
+  display,        // page re-rendered -> response frame written (includes queueing and pacing)
+  total           // event frame received -> response frame written
+};
+constexpr uint8_t LATENCY_STAGE_COUNT = 6u;
+
+const char *to_string(latency_stage stage);
+
+// Counts of latency samples in fixed, roughly logarithmic buckets
+class LatencyHistogram {
+public:
+  static constexpr uint8_t BUCKET_COUNT = 10u;
+  // upper bound (ms) of each bucket, the last bucket holds everything above
+  static const uint16_t BUCKET_LIMITS[BUCKET_COUNT - 1];
+
+  void record(uint32_t ms);
+  void clear();
+  uint32_t get_count() const { return this->count_; }
+  uint32_t get_max() const { return this->max_; }
+  uint32_t get_mean() const { return this->count_ == 0 ? 0 : this->sum_ / this->count_; }
+  // Upper bound of the bucket holding the given percentile (0-100), 'max' for the last bucket
+  uint32_t get_percentile(uint8_t percentile) const;
+  uint32_t get_bucket(uint8_t index) const { return this->buckets_[index]; }
+
+protected:
+  std::array<uint32_t, BUCKET_COUNT> buckets_{};
+  uint32_t count_ = 0;
+  uint32_t max_ = 0;
+  uint64_t sum_ = 0;
+};
+
+// Follows a single interaction at a time through the stages and records the
+// time spent in each of them. A new event abandons an interaction that didn't finish.
+class LatencyTracker {
+public:
+  void on_frame(uint32_t now);
+  // Time of the last frame received from the TFT
+  uint32_t get_frame_at() const { return this->frame_at_; }
+  // 'received_at' is the time of the frame the event came with, which is older than
+  // the last frame for events that were held back by the ButtonCoalescer
+  void on_dispatch(uint32_t received_at, uint32_t now);
+  void on_service_call(const std::string &entity_id, uint32_t now);
+  void on_state_update(const std::string &entity_id, uint32_t now);
+  void on_render(uint32_t now);
+  void on_frame_sent(uint32_t now);
+
+  const LatencyHistogram &get_histogram(latency_stage stage) const {
+    return this->histograms_[static_cast<uint8_t>(stage)];
+  }
+  // Samples recorded since the last call to clear_window()
+  const LatencyHistogram &get_window(latency_stage stage) const {
+    return this->window_[static_cast<uint8_t>(stage)];
+  }
+  void clear_window();
+
+protected:
+  void record_(latency_stage stage, uint32_t ms);
+
+  std::array<LatencyHistogram, LATENCY_STAGE_COUNT> histograms_;
+  std::array<LatencyHistogram, LATENCY_STAGE_COUNT> window_;
+
+  uint32_t frame_at_ = 0;
+  uint32_t started_at_ = 0;
+  uint32_t dispatched_at_ = 0;
+  uint32_t called_at_ = 0;
+  uint32_t updated_at_ = 0;
+  uint32_t rendered_at_ = 0;
+  std::string entity_id_;
+  enum class state_t : uint8_t { idle, dispatched, called, updated, rendered } state_ = state_t::idle;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
@@ -30,34 +30,22 @@ namespace nspanel_lovelace {
 
 // Use PSRAM for ArduinoJson (if available, otherwise use normal malloc)
 // see: https://arduinojson.org/v6/how-to/use-external-ram-on-esp32/#how-to-use-the-psram-with-arduinojson
-struct SpiRamAllocator {
-  void* allocate(size_t size) {
-   if (psram_available())
-     return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
-   else
-     return malloc(size);
-  }
-
-  void deallocate(void* pointer) {
-    if (psram_available())
-      heap_caps_free(pointer);
-    else
-      return free(pointer);
-  }
-
-  void* reallocate(void* ptr, size_t new_size) {
-    if (psram_available())
-      return heap_caps_realloc(ptr, new_size, MALLOC_CAP_SPIRAM);
-    else
-      return realloc(ptr, new_size);
-  }
-};
 using SpiRamJsonDocument = BasicJsonDocument<SpiRamAllocator>;
 
 static const char *const TAG = "nspanel_lovelace";
 
 NSPanelLovelace::NSPanelLovelace() {
   command_buffer_.reserve(1024);
+  rx_message_.reserve(128);
+  button_coalescer_.set_handler([this](const std::string &internal_id,
+      const std::string &button_type, const std::string &value, uint32_t received_at) {
+    // trailing-edge presses are dispatched from loop(), after process_command_()
+    // has dropped back to the page lane, but their responses are still interactive
+    auto priority = this->command_priority_;
+    this->command_priority_ = command_priority::interactive;
+    this->handle_button_press_(internal_id, button_type, value, received_at);
+    this->command_priority_ = priority;
+  });
 }
 
 bool NSPanelLovelace::restore_state_() {
@@ -79,231 +67,45 @@ bool NSPanelLovelace::save_state_() {
 
 void NSPanelLovelace::setup() {
   this->default_baud_rate_ = this->parent_->get_baud_rate();
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  this->start_rx_events_();
+#endif
 
   this->restore_state_();
 
 #ifdef USE_TIME
   this->setup_time_();
 #endif
+  auto free_heap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
   // todo: create entity for weather instead, so others can subscribe
   if (!this->weather_entity_id_.empty()) {
     // state provides the information for the icon
-    this->subscribe_homeassistant_state(
-        &NSPanelLovelace::on_weather_state_update_, this->weather_entity_id_);
-    this->subscribe_homeassistant_state(
-        &NSPanelLovelace::on_weather_temperature_update_,
-        this->weather_entity_id_, to_string(ha_attr_type::temperature));
-    this->subscribe_homeassistant_state(
-        &NSPanelLovelace::on_weather_temperature_unit_update_,
-        this->weather_entity_id_, to_string(ha_attr_type::temperature_unit));
-    this->subscribe_homeassistant_state(
-        &NSPanelLovelace::on_weather_forecast_update_, this->weather_entity_id_,
-        to_string(ha_attr_type::forecast));
+    this->subscribe_weather_(ha_attr_type::state);
+    this->subscribe_weather_(ha_attr_type::temperature);
+    this->subscribe_weather_(ha_attr_type::temperature_unit);
+    this->subscribe_weather_(ha_attr_type::forecast);
   }
   
-  for (auto &entity : this->entities_) {
-    auto &entity_id = entity->get_entity_id();
-    ESP_LOGV(TAG, "Adding subscriptions for entity '%s'", entity_id.c_str());
-    bool add_state_subscription = false;
-    if (entity->is_type(entity_type::light)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::supported_color_modes));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::color_mode));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::min_mireds));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::max_mireds));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::color_temp));
-      // need to subscribe to brightness to know if brightness is supported
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::brightness));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::effect_list));
-    }
-    else if (entity->is_type(entity_type::switch_) ||
-        entity->is_type(entity_type::input_boolean) ||
-        entity->is_type(entity_type::input_text) ||
-        entity->is_type(entity_type::text) ||
-        entity->is_type(entity_type::automation) ||
-        entity->is_type(entity_type::sun) ||
-        entity->is_type(entity_type::vacuum) ||
-        entity->is_type(entity_type::lock) ||
-        entity->is_type(entity_type::person)) {
-      add_state_subscription = true;
-    }
-    // icons and unit_of_measurement based on state and device_class
-    else if (entity->is_type(entity_type::sensor) ||
-        entity->is_type(entity_type::binary_sensor)) {
-      add_state_subscription = true;
-      // if (!entity->is_icon_value_overridden()) {
-        this->subscribe_homeassistant_state_attr(
-            &NSPanelLovelace::on_entity_attribute_update_, 
-            entity_id, to_string(ha_attr_type::device_class));
-      // }
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::unit_of_measurement));
-    }
-    else if (entity->is_type(entity_type::cover)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::device_class));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::supported_features));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::current_position));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::current_tilt_position));
+  for (auto &entity : this->entities_.get_entities()) {
+    ESP_LOGV(TAG, "Adding subscriptions for entity '%s'", entity->get_entity_id().c_str());
+    auto attributes = this->get_entity_subscriptions_(*entity);
+    for (uint8_t i = 0; i < (sizeof(ha_attr_names) / sizeof(*ha_attr_names)); i++) {
+      auto attr = static_cast<ha_attr_type>(i);
+      if (attr == ha_attr_type::state || !(attributes & ha_attr_mask(attr))) continue;
+      this->subscribe_entity_(*entity, attr);
     }
-    else if (entity->is_type(entity_type::alarm_control_panel)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::code_arm_required));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::open_sensors));
-    }
-    else if (entity->is_type(entity_type::timer)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::editable));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::duration));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::remaining));
-      this->subscribe_homeassistant_state_attr(
-        &NSPanelLovelace::on_entity_attribute_update_,
-        entity_id, to_string(ha_attr_type::finishes_at));
-    }
-    else if (entity->is_type(entity_type::climate)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::temperature));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::current_temperature));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::target_temp_high));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::target_temp_low));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::target_temp_step));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::min_temp));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::max_temp));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::hvac_action));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::preset_modes));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::swing_modes));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::fan_modes));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::hvac_modes));
-    }
-    else if (entity->is_type(entity_type::media_player)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::supported_features));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::media_content_type));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::media_title));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::media_artist));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::volume_level));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::shuffle));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::source_list));
-    }
-    else if (entity->is_type(entity_type::select) ||
-        entity->is_type(entity_type::input_select)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::options));
-    }
-    else if (entity->is_type(entity_type::number) ||
-        entity->is_type(entity_type::input_number)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::min));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::max));
-    }
-    else if (entity->is_type(entity_type::weather)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::temperature));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::temperature_unit));
-    }
-    else if (entity->is_type(entity_type::fan)) {
-      add_state_subscription = true;
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::percentage_step));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::percentage));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::preset_modes));
-      this->subscribe_homeassistant_state_attr(
-          &NSPanelLovelace::on_entity_attribute_update_, 
-          entity_id, to_string(ha_attr_type::preset_mode));
-    }
-
-    if (add_state_subscription) {
-      this->subscribe_homeassistant_state(
-        &NSPanelLovelace::on_entity_state_update_,
-        entity_id);
+    // the state is subscribed last so the attributes are known when it arrives
+    if (attributes & ha_attr_mask(ha_attr_type::state)) {
+      this->subscribe_entity_(*entity, ha_attr_type::state);
     }
   }
+  auto used_heap = free_heap - heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  // the heap can also have grown (other tasks freed memory) while subscribing
+  this->subscription_heap_ = used_heap <= free_heap ? used_heap : 0;
+
+  // all pages are assembled by now
+  this->build_page_index_();
+  this->size_frame_pool_();
 
   this->set_timeout(1000, [this]() {
     // The display isn't reset when ESP is reset (on ota update etc.)
@@ -315,11 +117,20 @@ void NSPanelLovelace::setup() {
     auto reason = esp_reset_reason();
     if (reason == esp_reset_reason_t::ESP_RST_SW ||
         reason == esp_reset_reason_t::ESP_RST_DEEPSLEEP/* ||
-        reason == esp_reset_reason_t::ESP_RST_USB*/) {
+        reason == esp_reset_reason_t::ESP_RST_USB*/ ||
+        // the TFT could still be running at the high baud rate
+        (this->high_baud_rate_ > 0 && reason != esp_reset_reason_t::ESP_RST_POWERON)) {
       this->soft_reset_display();
     }
 #endif
   });
+
+#ifdef USE_SENSOR
+  if (std::any_of(this->latency_sensors_.begin(), this->latency_sensors_.end(),
+      [](sensor::Sensor *sensor) { return sensor != nullptr; })) {
+    this->set_interval("latency", LATENCY_PUBLISH_INTERVAL, [this]() { this->publish_latency_(); });
+  }
+#endif
 }
 
 void NSPanelLovelace::loop() {
@@ -328,20 +139,60 @@ void NSPanelLovelace::loop() {
     return;
   }
 #endif
+  // the baud rate handshake owns the UART until it has finished
+  if (this->baud_switching_) return;
+
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  bool rx_pending = this->rx_task_ == nullptr || this->rx_pending_.exchange(false);
+  this->check_rx_line_errors_();
+  // nothing to do until the UART driver reports new data, unless work is left over
+  if (!rx_pending && this->decoder_.pending() == 0 &&
+      !this->force_current_page_update_ && this->command_queue_.empty() &&
+      !this->button_coalescer_.has_pending() && !this->render_scheduler_.has_pending()) {
+    return;
+  }
+#else
+  bool rx_pending = true;
+#endif
 
   // Monitor for commands arriving from the screen over UART
-  uint8_t d;
-  while (this->available()) {
-    this->read_byte(&d);
-    this->buffer_.push_back(d);
-    if (!this->process_data_()) {
-      ESP_LOGW(TAG, "Unparsed data: %s", esphome::format_hex(this->buffer_).c_str());
-      this->buffer_.clear();
-    }
+  int available = 0;
+  while (rx_pending && (available = this->available()) > 0) {
+    size_t length;
+    uint8_t *data = this->decoder_.write_ptr(length);
+    if (length == 0) break;
+    if (length > static_cast<size_t>(available))
+      length = available;
+    if (!this->read_array(data, length)) break;
+    this->decoder_.commit(length);
+    this->rx_last_received_ = millis();
+    this->process_data_();
+  }
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  // the decoder is full, read the rest in the next loop
+  if (available > 0) this->rx_pending_.store(true);
+#endif
+
+  // Drop a frame that stopped arriving midway (e.g. bytes lost to noise)
+  // so the bytes after its first one are scanned for the next frame
+  if (this->decoder_.pending() > 0 &&
+      (millis() - this->rx_last_received_) > TFT_FRAME_TIMEOUT) {
+    ESP_LOGW(TAG, "Incomplete frame timed out (%u bytes pending)", this->decoder_.pending());
+    this->decoder_.resync();
+    this->on_rx_error_();
+    this->process_data_();
+  }
+
+  // Handle the latest value of controls that were moved within their interval
+  this->button_coalescer_.loop(millis());
+
+  if (this->render_scheduler_.is_frame_due(millis())) {
+    this->render_dirty_entities_();
   }
 
   if (this->force_current_page_update_) {
     this->force_current_page_update_ = false;
+    this->latency_tracker_.on_render(millis());
     ESP_LOGD(TAG, "Render HA update");
     if (this->popup_page_current_uuid_.empty()) {
       this->render_item_update_(this->current_page_);
@@ -351,23 +202,112 @@ void NSPanelLovelace::loop() {
   }
 
   // Throttle command processing to avoid flooding the display with commands
-  if ((millis() - this->command_last_sent_) > COMMAND_COOLDOWN) {
+  if (this->command_pacer_.is_ready(millis())) {
     this->process_display_command_queue_();
   }
 }
 
-std::shared_ptr<Entity> NSPanelLovelace::create_entity(const std::string &entity_id) {
-  for (auto &e : this->entities_) {
-    if (entity_id == e->get_entity_id()) return e;
+// Everything the cards and popups can show for an entity of the type,
+// used when the configuration didn't generate its subscriptions
+static ha_attr_mask_t default_entity_subscriptions_(const Entity &entity) {
+  if (entity.is_type(entity_type::light)) {
+    // need to subscribe to brightness to know if brightness is supported
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::supported_color_modes, ha_attr_type::color_mode,
+      ha_attr_type::min_mireds, ha_attr_type::max_mireds, ha_attr_type::color_temp,
+      ha_attr_type::brightness, ha_attr_type::effect_list);
+  }
+  if (entity.is_type(entity_type::switch_) ||
+      entity.is_type(entity_type::input_boolean) ||
+      entity.is_type(entity_type::input_text) ||
+      entity.is_type(entity_type::text) ||
+      entity.is_type(entity_type::automation) ||
+      entity.is_type(entity_type::sun) ||
+      entity.is_type(entity_type::vacuum) ||
+      entity.is_type(entity_type::lock) ||
+      entity.is_type(entity_type::person)) {
+    return ha_attr_mask(ha_attr_type::state);
+  }
+  // icons and unit_of_measurement based on state and device_class
+  if (entity.is_type(entity_type::sensor) ||
+      entity.is_type(entity_type::binary_sensor)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::device_class, ha_attr_type::unit_of_measurement);
+  }
+  if (entity.is_type(entity_type::cover)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::device_class, ha_attr_type::supported_features,
+      ha_attr_type::current_position, ha_attr_type::current_tilt_position);
+  }
+  if (entity.is_type(entity_type::alarm_control_panel)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::code_arm_required, ha_attr_type::open_sensors);
+  }
+  if (entity.is_type(entity_type::timer)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::editable, ha_attr_type::duration,
+      ha_attr_type::remaining, ha_attr_type::finishes_at);
+  }
+  if (entity.is_type(entity_type::climate)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::temperature, ha_attr_type::current_temperature,
+      ha_attr_type::target_temp_high, ha_attr_type::target_temp_low,
+      ha_attr_type::target_temp_step, ha_attr_type::min_temp, ha_attr_type::max_temp,
+      ha_attr_type::hvac_action, ha_attr_type::hvac_modes,
+      ha_attr_type::preset_modes, ha_attr_type::preset_mode,
+      ha_attr_type::swing_modes, ha_attr_type::swing_mode,
+      ha_attr_type::fan_modes, ha_attr_type::fan_mode);
+  }
+  if (entity.is_type(entity_type::media_player)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::supported_features, ha_attr_type::media_content_type,
+      ha_attr_type::media_title, ha_attr_type::media_artist,
+      ha_attr_type::volume_level, ha_attr_type::shuffle,
+      ha_attr_type::source, ha_attr_type::source_list);
+  }
+  if (entity.is_type(entity_type::select) ||
+      entity.is_type(entity_type::input_select)) {
+    return ha_attr_mask(ha_attr_type::state, ha_attr_type::options);
+  }
+  if (entity.is_type(entity_type::number) ||
+      entity.is_type(entity_type::input_number)) {
+    return ha_attr_mask(ha_attr_type::state, ha_attr_type::min, ha_attr_type::max);
+  }
+  if (entity.is_type(entity_type::weather)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::temperature, ha_attr_type::temperature_unit);
+  }
+  if (entity.is_type(entity_type::fan)) {
+    return ha_attr_mask(ha_attr_type::state,
+      ha_attr_type::percentage_step, ha_attr_type::percentage,
+      ha_attr_type::preset_modes, ha_attr_type::preset_mode);
+  }
+  return ha_attr_mask();
+}
+
+ha_attr_mask_t NSPanelLovelace::get_entity_subscriptions_(const Entity &entity) const {
+  auto &entity_id = entity.get_entity_id();
+  // the table is generated in the order the entities are created
+  auto handle = entity.get_handle();
+  if (handle < this->entity_subscription_count_ &&
+      entity_id == this->entity_subscriptions_[handle].entity_id) {
+    return this->entity_subscriptions_[handle].attributes;
+  }
+  for (size_t i = 0; i < this->entity_subscription_count_; i++) {
+    if (entity_id == this->entity_subscriptions_[i].entity_id)
+      return this->entity_subscriptions_[i].attributes;
   }
-  auto entity = std::make_shared<Entity>(entity_id);
-  this->entities_.push_back(entity);
-  return entity;
+  return default_entity_subscriptions_(entity);
+}
+
+std::shared_ptr<Entity> NSPanelLovelace::create_entity(const std::string &entity_id) {
+  return this->entities_.create(entity_id);
 }
 
 void NSPanelLovelace::on_page_item_added_callback(const std::shared_ptr<PageItem> &item) {
   bool found = false;
   auto &item_uuid = item->get_uuid();
+  this->page_index_.invalidate();
 
   if (page_item_cast<StatefulPageItem>(item.get())) {
     for (auto &item : this->stateful_page_items_) {
@@ -433,72 +373,57 @@ void NSPanelLovelace::set_display_dim(uint8_t inactive, uint8_t active) {
   this->send_buffered_command_();
 }
 
-bool NSPanelLovelace::process_data_() {
-  uint32_t at = this->buffer_.size() - 1;
-  auto *data = &this->buffer_[0];
-  uint8_t new_byte = data[at];
+#ifdef USE_NSPANEL_TRAFFIC_CAPTURE
+static capture_type to_capture_type_(tft_frame_type type) {
+  switch (type) {
+  case tft_frame_type::message: return capture_type::message;
+  case tft_frame_type::startup: return capture_type::startup;
+  case tft_frame_type::ready: return capture_type::ready;
+  case tft_frame_type::crc_mismatch: return capture_type::crc_mismatch;
+  default: return capture_type::invalid;
+  }
+}
+#endif
 
-  // Nextion Startup event
-  // todo: store 'tft_connected' state?
-  if (data[0] == 0x0) {
-    if (at > 5) return false;
-    static constexpr uint8_t seq[] = {0x00,0x00,0x00,0xFF,0xFF,0xFF};
-    if (at == 5 && data[at] == seq[at]) {
+void NSPanelLovelace::process_data_() {
+  tft_frame_type type;
+  while ((type = this->decoder_.decode()) != tft_frame_type::none) {
+#ifdef USE_NSPANEL_TRAFFIC_CAPTURE
+    this->traffic_capture_.record(to_capture_type_(type),
+      millis(), this->decoder_.data(), this->decoder_.length());
+#endif
+    switch (type) {
+    case tft_frame_type::message:
+      this->rx_message_.assign(
+        reinterpret_cast<const char *>(this->decoder_.data()),
+        this->decoder_.length());
+      this->latency_tracker_.on_frame(millis());
+      this->process_command_(this->rx_message_);
+      break;
+    // todo: store 'tft_connected' state?
+    case tft_frame_type::startup:
       ESP_LOGD(TAG, "Nextion started");
-      this->buffer_.clear();
-    }
-    return data[at] == seq[at];
-  }
-  // Nextion Ready event
-  // note: This event can be removed by custom firmware and may never occur
-  if (data[0] == 0x88) {
-    if (at > 3) return false;
-    static constexpr uint8_t seq[] = {0x88,0xFF,0xFF,0xFF};
-    if (at == 3 && data[at] == seq[at]) {
+      this->display_shadow_.invalidate();
+      break;
+    case tft_frame_type::ready:
       ESP_LOGD(TAG, "Nextion ready");
-      this->buffer_.clear();
+      break;
+    case tft_frame_type::crc_mismatch:
+      ESP_LOGW(TAG, "Received invalid message checksum: %s",
+        esphome::format_hex(this->decoder_.data(), this->decoder_.length()).c_str());
+      this->command_pacer_.on_overload(millis());
+      // the TFT may have been trying to tell us about a change
+      this->display_shadow_.invalidate_page();
+      this->on_rx_error_();
+      break;
+    default:
+      ESP_LOGW(TAG, "Unparsed data: %s",
+        esphome::format_hex(this->decoder_.data(), this->decoder_.length()).c_str());
+      this->command_pacer_.on_overload(millis());
+      this->on_rx_error_();
+      break;
     }
-    return data[at] == seq[at];
-  }
-
-  // Byte 0: HEADER1 (always 0x55)
-  if (at == 0)
-    return new_byte == 0x55;
-  // Byte 1: HEADER2 (always 0xBB)
-  if (at == 1)
-    return new_byte == 0xBB;
-
-  // Byte 3 & 4 - length (little endian)
-  if (at == 2 || at == 3) {
-    return true;
-  }
-  uint16_t length = encode_uint16(data[3], data[2]);
-
-  // Wait until all data comes in
-  if (at - 4 < length) {
-    //    ESP_LOGD(TAG, "Message (%d/%d): 0x%02x", at - 3, length, new_byte);
-    return true;
-  }
-
-  // Last two bytes: CRC; return after first one
-  if (at == 4 + length) {
-    return true;
-  }
-
-  uint16_t crc16 = encode_uint16(data[4 + length + 1], data[4 + length]);
-  uint16_t calculated_crc16 = esphome::crc16(data, 4 + length);
-
-  if (crc16 != calculated_crc16) {
-    ESP_LOGW(TAG, "Received invalid message checksum %02X!=%02X", crc16, calculated_crc16);
-    return false;
   }
-
-  const uint8_t *message_data = data + 4;
-  std::string message(message_data, message_data + length);
-
-  this->process_command_(message);
-  this->buffer_.clear();
-  return true;
 }
 
 #ifdef TEST_DEVICE_MODE
@@ -510,32 +435,51 @@ void NSPanelLovelace::process_command(const std::string &message) {
 void NSPanelLovelace::process_command_(const std::string &message) {
   ESP_LOGD(TAG, "TFT CMD IN: %s", message.c_str());
 
-  std::vector<std::string> tokens;
-  tokens.reserve(5);
-  split_str(',', message, tokens);
-  if (tokens.size() < 2 || tokens.at(0) != "event") { return; }
+  // The TFT repeats an event when it didn't get (or couldn't process) the response in time.
+  // A repeat after a frame was sent is a user pressing twice (e.g. a double tap), not an overload.
+  if (this->command_pacer_.get_policy() == command_pacing_t::adaptive) {
+    auto now = millis();
+    if ((now - this->last_incoming_msg_time_) < 250 && message == this->last_incoming_msg_ &&
+        !this->command_pacer_.has_sent_since(this->last_incoming_msg_time_, now)) {
+      this->command_pacer_.on_overload(now);
+    }
+    this->last_incoming_msg_.assign(message);
+    this->last_incoming_msg_time_ = now;
+  }
+
+  // event,{action},{internal_id},{button_type},{value}
+  // one more than needed so events with too many items can be told apart
+  str_span tokens[6];
+  auto token_count = split_str(',', message, tokens, 6);
+  if (token_count < 2 || tokens[0] != "event") { return; }
+
+  this->command_priority_ = command_priority::interactive;
+  // the user may have changed what is displayed, so the response must not be skipped
+  this->display_shadow_.invalidate_page();
 
   // note: from luibackend/mqtt.py
-  if (tokens.at(1) == action_type::buttonPress2) {
-    if (tokens.size() == 5) {
-      this->process_button_press_(tokens.at(2), tokens.at(3), tokens.at(4));
-    } else if (tokens.size() == 4) {
-      this->process_button_press_(tokens.at(2), tokens.at(3));
-    }
-  } else if (tokens.at(1) == action_type::pageOpenDetail) {
-    this->render_popup_page_(tokens.at(3));
-  } else if (tokens.at(1) == action_type::sleepReached) {
+  if (tokens[1] == action_type::buttonPress2) {
+    if (token_count == 5) {
+      this->process_button_press_(tokens[2], tokens[3], tokens[4]);
+    } else if (token_count == 4) {
+      this->process_button_press_(tokens[2], tokens[3]);
+    }
+  } else if (tokens[1] == action_type::pageOpenDetail) {
+    if (token_count >= 4)
+      this->render_popup_page_(tokens[3].str());
+  } else if (tokens[1] == action_type::sleepReached) {
     //std::string page = tokens.at(2);
 
     // todo: temporary, render default page instead
     this->render_page_(render_page_option::screensaver);
-  } else if (tokens.at(1) == action_type::startup) {
-    if (tokens.size() == 4) {
+  } else if (tokens[1] == action_type::startup) {
+    this->display_shadow_.invalidate();
+    if (token_count == 4) {
       uint16_t ver = 0;
-      if(std::sscanf(tokens.at(2).c_str(), "%" PRIu16, &ver) == 1) {
+      if(std::sscanf(tokens[2].str().c_str(), "%" PRIu16, &ver) == 1) {
         Configuration::set_version(ver);
       }
-      Configuration::set_model(tokens.at(3));
+      Configuration::set_model(tokens[3].str());
     }
     if (Configuration::get_model() == nspanel_model_t::unknown) {
       ESP_LOGW(TAG, "Unknown NSPanel model!");
@@ -543,6 +487,11 @@ void NSPanelLovelace::process_command_(const std::string &message) {
     if (Configuration::get_version() == 0) {
       ESP_LOGW(TAG, "Unknown NSPanel version!");
     }
+#ifndef TEST_DEVICE_MODE
+    // the initial page is held in the queue until the switch has finished,
+    // so it is already sent at the higher rate
+    this->negotiate_high_baud_rate_();
+#endif
     // restore dimmode state
     this->set_display_dim();
     this->render_page_(render_page_option::screensaver);
@@ -555,6 +504,7 @@ void NSPanelLovelace::process_command_(const std::string &message) {
   }
 
   this->incoming_msg_callback_.call(message);
+  this->command_priority_ = command_priority::page;
 }
 
 void NSPanelLovelace::render_page_(size_t index) {
@@ -753,18 +703,13 @@ void NSPanelLovelace::render_cover_detail_update_(StatefulPageItem *item) {
     entity->get_attribute(ha_attr_type::device_class),
     entity_cover_type::window);
 
-  auto &position_str = entity->
-    get_attribute(ha_attr_type::current_position);
-  auto &supported_features_str = entity->
-    get_attribute(ha_attr_type::supported_features);
-  auto &tilt_position_str = entity->
-    get_attribute(ha_attr_type::current_tilt_position);
-
-  uint8_t position = value_or_default(position_str, 0U);
-  uint8_t tilt_position = value_or_default(entity->
-    get_attribute(ha_attr_type::current_tilt_position), 0U);
-  uint16_t supported_features = value_or_default(entity->
-    get_attribute(ha_attr_type::supported_features), 0U);
+  bool has_position = entity->has_attribute(ha_attr_type::current_position);
+  uint8_t position = entity->
+    get_attribute_number(ha_attr_type::current_position, 0);
+  uint8_t tilt_position = entity->
+    get_attribute_number(ha_attr_type::current_tilt_position, 0);
+  uint16_t supported_features = entity->
+    get_attribute_number(ha_attr_type::supported_features, 0);
 
   // Icons
   const icon_char_t* cover_icon = icon_t::none;
@@ -805,7 +750,7 @@ void NSPanelLovelace::render_cover_detail_update_(StatefulPageItem *item) {
   if (supported_features & 0b00000001) {
     if (position != 100 && !((entity->is_state(entity_state::open) ||
         entity->is_state(entity_state::unknown)) &&
-        position_str.empty())) {
+        !has_position)) {
       icon_up_status = true;
     }
     if (cover_icons_found)
@@ -815,7 +760,7 @@ void NSPanelLovelace::render_cover_detail_update_(StatefulPageItem *item) {
   if (supported_features & 0b00000010) {
     if (position != 0 && !((entity->is_state(entity_state::closed) ||
         entity->is_state(entity_state::unknown)) &&
-        position_str.empty())) {
+        !has_position)) {
       icon_down_status = true;
     }
     if (cover_icons_found)
@@ -919,17 +864,17 @@ void NSPanelLovelace::render_light_detail_update_(StatefulPageItem *item) {
   if (item == nullptr) return;
 
   auto entity = item->get_entity();
-  auto &supported_modes = entity->get_attribute(ha_attr_type::supported_color_modes);
+  auto &supported_modes = entity->get_attribute_list(ha_attr_type::supported_color_modes);
   bool enable_color_wheel = entity->is_state(entity_state::on) &&
-      (contains_value(supported_modes, ha_attr_color_mode::xy) || 
-      contains_value(supported_modes, ha_attr_color_mode::hs) ||
-      contains_value(supported_modes, ha_attr_color_mode::rgb) ||
-      contains_value(supported_modes, ha_attr_color_mode::rgbw) ||
-      contains_value(supported_modes, ha_attr_color_mode::rgbww));
+      (supported_modes.contains(ha_attr_color_mode::xy) || 
+      supported_modes.contains(ha_attr_color_mode::hs) ||
+      supported_modes.contains(ha_attr_color_mode::rgb) ||
+      supported_modes.contains(ha_attr_color_mode::rgbw) ||
+      supported_modes.contains(ha_attr_color_mode::rgbww));
 
   std::string color_mode = entity->get_attribute(ha_attr_type::color_mode);
   std::string color_temp = generic_type::disable;
-  if (contains_value(supported_modes, ha_attr_color_mode::color_temp)) {
+  if (supported_modes.contains(ha_attr_color_mode::color_temp)) {
     if (color_mode == ha_attr_color_mode::color_temp) {
       color_temp = entity->get_attribute(ha_attr_type::color_temp, generic_type::disable);
     } else {
@@ -969,15 +914,15 @@ void NSPanelLovelace::render_light_detail_update_(StatefulPageItem *item) {
 void NSPanelLovelace::render_timer_detail_update_(StatefulPageItem *item) {
   if (item == nullptr) return;
 
-  auto &state = item->get_state();
   bool render = false;
   uint16_t min_remaining = 0, sec_remaining = 0;
-  bool idle = state == entity_state::paused || state == entity_state::idle;
+  bool paused = item->is_state(entity_state::paused);
+  bool idle = paused || item->is_state(entity_state::idle);
 
   if (idle) {
     this->cancel_interval(entity_type::timer);
     std::string time_remaining_str;
-    if (state == entity_state::paused) {
+    if (paused) {
       time_remaining_str = item->get_attribute(ha_attr_type::remaining);
     } else {
       time_remaining_str = item->get_attribute(ha_attr_type::duration);
@@ -986,9 +931,14 @@ void NSPanelLovelace::render_timer_detail_update_(StatefulPageItem *item) {
       std::vector<std::string> time_parts;
       split_str(':', time_remaining_str, time_parts);
       if (time_parts.size() == 3) {
-        min_remaining = (stoi(time_parts[0]) * 60) + stoi(time_parts[1]);
-        sec_remaining = stoi(time_parts[2]);
-        render = true;
+        int32_t hours, minutes, seconds;
+        if (parse_number(time_parts[0], hours) &&
+            parse_number(time_parts[1], minutes) &&
+            parse_number(time_parts[2], seconds)) {
+          min_remaining = (hours * 60) + minutes;
+          sec_remaining = seconds;
+          render = true;
+        }
       }
     }
   }
@@ -1066,16 +1016,15 @@ void NSPanelLovelace::render_climate_detail_update_(Entity *entity, const std::s
   if(entity == nullptr) return;
 
   uint16_t icon_colour = 64512U;
-  auto &state = entity->get_state();
-  if (state == entity_state::auto_ ||
-      state == entity_state::heat_cool) {
+  if (entity->is_state(entity_state::auto_) ||
+      entity->is_state(entity_state::heat_cool)) {
     icon_colour = 1024U;
-  } else if (state == entity_state::off ||
-      state == entity_state::fan_only) {
+  } else if (entity->is_state(entity_state::off) ||
+      entity->is_state(entity_state::fan_only)) {
     icon_colour = 35921U;
-  } else if (state == entity_state::cool) {
+  } else if (entity->is_state(entity_state::cool)) {
     icon_colour = 11487U;
-  } else if (state == entity_state::dry) {
+  } else if (entity->is_state(entity_state::dry)) {
     icon_colour = 60897U;
   }
 
@@ -1096,42 +1045,35 @@ void NSPanelLovelace::render_climate_detail_update_(Entity *entity, const std::s
     // icon_color~
     .append(std::to_string(icon_colour)).append(1, SEPARATOR);
 
-  std::vector<ha_attr_type> mode_types = {
-    ha_attr_type::preset_modes,
-    ha_attr_type::swing_modes,
-    ha_attr_type::fan_modes
+  // the list of modes and the attribute holding the current one
+  static constexpr std::pair<ha_attr_type, ha_attr_type> mode_types[] = {
+    {ha_attr_type::preset_modes, ha_attr_type::preset_mode},
+    {ha_attr_type::swing_modes, ha_attr_type::swing_mode},
+    {ha_attr_type::fan_modes, ha_attr_type::fan_mode}
   };
 
-  for (auto mt : mode_types) {
-    auto &supported_modes = entity->get_attribute(mt);
+  for (auto &mode_type : mode_types) {
+    auto mt = mode_type.first;
+    auto &supported_modes = entity->get_attribute_list(mt);
     if (supported_modes.empty()) continue;
     
     std::string mode_res;
     if (mt == ha_attr_type::preset_modes) {
-      mode_res.reserve(supported_modes.size());
-      size_t pos_start = std::string::npos, pos_end = pos_start;
-      do {
-        pos_end = supported_modes.find(',', pos_start + 1);
-        mode_res.append(
-          get_translation(
-            supported_modes.substr(pos_start + 1, pos_end - pos_start - 1)));
-        if (pos_end != std::string::npos) mode_res.append(1, '?');
-        pos_start = pos_end;
-      } while (pos_start != std::string::npos);
+      for (uint16_t i = 0; i < supported_modes.size(); i++) {
+        if (i > 0) mode_res.append(1, '?');
+        mode_res.append(get_translation(supported_modes.at(i)));
+      }
     } else {
-      mode_res = supported_modes;
-      replace_all(mode_res, ',', '?');
+      supported_modes.join(mode_res, '?');
     }
-    std::string mode_type = to_string(mt);
-    mode_type.pop_back();
 
     this->command_buffer_
       // heading~
-      .append(get_translation(mode_type)).append(1, SEPARATOR)
+      .append(get_translation(to_string(mode_type.second))).append(1, SEPARATOR)
       // mode~
       .append(to_string(mt)).append(1, SEPARATOR)
       // curr_mode~
-      .append(entity->get_attribute(to_ha_attr(mode_type))).append(1, SEPARATOR)
+      .append(entity->get_attribute(mode_type.second)).append(1, SEPARATOR)
       // mode_res~ (mode names separated by '?')
       .append(mode_res).append(1, SEPARATOR);
   }
@@ -1141,20 +1083,20 @@ void NSPanelLovelace::render_climate_detail_update_(Entity *entity, const std::s
 void NSPanelLovelace::render_input_select_detail_update_(StatefulPageItem *item) {
   if(item == nullptr) return;
 
-  auto state = item->get_state();
+  std::string state = item->get_state();
   std::string options;
+  auto entity = item->get_entity();
   if (item->is_type(entity_type::input_select) || 
       item->is_type(entity_type::select)) {
-    options = item->get_attribute(ha_attr_type::options);
+    entity->get_attribute_list(ha_attr_type::options).join(options, '?');
   }
   else if (item->is_type(entity_type::light)) {
-    options = item->get_attribute(ha_attr_type::effect_list);
+    entity->get_attribute_list(ha_attr_type::effect_list).join(options, '?');
   }
   else if (item->is_type(entity_type::media_player)) {
-    options = item->get_attribute(ha_attr_type::source_list);
+    entity->get_attribute_list(ha_attr_type::source_list).join(options, '?');
     state = item->get_attribute(ha_attr_type::source);
   }
-  if (!options.empty()) replace_all(options, ',', '?');
 
   this->command_buffer_
     // entityUpdateDetail2~
@@ -1178,22 +1120,19 @@ void NSPanelLovelace::render_fan_detail_update_(StatefulPageItem *item) {
   auto speed = item->get_attribute(ha_attr_type::percentage);
   auto percentage_step = item->get_attribute(ha_attr_type::percentage_step);
   auto preset_mode = item->get_attribute(ha_attr_type::preset_mode);
-  auto preset_modes = item->get_attribute(ha_attr_type::preset_modes);
-  if (!preset_modes.empty()) replace_all(preset_modes, ',', '?');
+  std::string preset_modes;
+  item->get_entity()->get_attribute_list(
+    ha_attr_type::preset_modes).join(preset_modes, '?');
 
   uint8_t speed_max = 100;
   if (!percentage_step.empty()) {
-    float speed_val = 0.0f;
-    if (speed.empty()) {
-      speed = "0";
-    } else {
-      speed_val = std::stof(speed);
-    }
-    auto step_val = std::stof(percentage_step);
-    if (step_val < 1.0f) step_val = 1.0f; // avoid divide-by-zero
-    speed = esphome::to_string(
-      static_cast<uint16_t>(round(speed_val / step_val)));
-    speed_max = static_cast<uint16_t>(round(100.0f / step_val));
+    // percentages in hundredths, rounded to the nearest step
+    int32_t speed_val = item->get_attribute_number(ha_attr_type::percentage, 0, 2);
+    int32_t step_val = item->get_attribute_number(ha_attr_type::percentage_step, 0, 2);
+    if (step_val < 100) step_val = 100; // avoid divide-by-zero
+    speed.clear();
+    append_number(speed, (speed_val + step_val / 2) / step_val);
+    speed_max = (10000 + step_val / 2) / step_val;
   }
 
   this->command_buffer_
@@ -1232,7 +1171,76 @@ void NSPanelLovelace::dump_config() {
       this->pages_.size(),
       this->stateful_page_items_.size(),
       this->entities_.size());
+  ESP_LOGCONFIG(TAG, "\tState: subscriptions:%u,subscription_heap:%" PRIu32,
+      this->subscription_count_,
+      this->subscription_heap_);
+  size_t attribute_slots = 0, attribute_memory = 0;
+  for (auto &entity : this->entities_.get_entities()) {
+    attribute_slots += entity->get_attribute_slot_count();
+    attribute_memory += entity->get_attribute_memory();
+  }
+  ESP_LOGCONFIG(TAG, "\tState: attribute_slots:%zu,attribute_bytes:%zu",
+      attribute_slots, attribute_memory);
+  ESP_LOGCONFIG(TAG, "\tState: page_index_bytes:%zu", this->page_index_.get_memory());
+  ESP_LOGCONFIG(TAG, "\tRX: dropped_bytes:%" PRIu32 ",crc_errors:%" PRIu32,
+      this->decoder_.get_dropped_bytes(),
+      this->decoder_.get_crc_errors());
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  ESP_LOGCONFIG(TAG, "\tRX: mode:%s,line_errors:%" PRIu32,
+      this->rx_task_ != nullptr ? "events" : "polling",
+      this->rx_line_errors_.load());
+#endif
+  ESP_LOGCONFIG(TAG, "\tUART: baud:%" PRIu32 ",default:%" PRIu32 ",high:%" PRIu32 "%s,fallbacks:%" PRIu32,
+      this->parent_->get_baud_rate(),
+      this->default_baud_rate_,
+      this->high_baud_rate_,
+      this->high_baud_failed_ ? " (failed)" : "",
+      this->baud_fallbacks_);
+  ESP_LOGCONFIG(TAG, "\tTX: frame_slots:%u/%u,slot_size:%u,overflows:%" PRIu32,
+      this->command_queue_.get_pool().get_used_count(),
+      this->command_queue_.get_pool().get_slot_count(),
+      this->command_queue_.get_pool().get_slot_size(),
+      this->command_queue_.get_overflow_count());
+  ESP_LOGCONFIG(TAG, "\tTX: pacing:%s,gap:%" PRIu32 "ms,backoff:%" PRIu32 "ms,overloads:%" PRIu32,
+      this->command_pacer_.get_policy() == command_pacing_t::adaptive ? "adaptive" : "fixed",
+      this->command_pacer_.get_gap(),
+      this->command_pacer_.get_backoff(),
+      this->command_pacer_.get_overload_count());
+  ESP_LOGCONFIG(TAG, "\tTX: skipped:%" PRIu32, this->display_shadow_.get_skipped_count());
+  ESP_LOGCONFIG(TAG, "\tButtons: interval:%" PRIu32 "ms,round_trip:%" PRIu32 "ms,coalesced:%" PRIu32,
+      this->button_coalescer_.get_interval(),
+      this->button_coalescer_.get_round_trip(),
+      this->button_coalescer_.get_coalesced_count());
+  ESP_LOGCONFIG(TAG, "\tRender: frame_interval:%ums,frames:%" PRIu32 ",updates:%" PRIu32,
+      this->render_scheduler_.get_frame_interval(),
+      this->render_scheduler_.get_frame_count(),
+      this->render_scheduler_.get_update_count());
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    auto stage = static_cast<latency_stage>(i);
+    auto &h = this->latency_tracker_.get_histogram(stage);
+    if (h.get_count() == 0) continue;
+    char buckets[LatencyHistogram::BUCKET_COUNT * 11];
+    size_t pos = 0;
+    for (uint8_t b = 0; b < LatencyHistogram::BUCKET_COUNT; b++) {
+      pos += snprintf(buckets + pos, sizeof(buckets) - pos, b == 0 ? "%" PRIu32 : "/%" PRIu32, h.get_bucket(b));
+    }
+    ESP_LOGCONFIG(TAG, "\tLatency %s: n:%" PRIu32 ",mean:%" PRIu32 "ms,p50:%" PRIu32 "ms,p95:%" PRIu32 "ms,max:%" PRIu32 "ms,buckets:%s",
+        to_string(stage), h.get_count(), h.get_mean(),
+        h.get_percentile(50), h.get_percentile(95), h.get_max(), buckets);
+  }
+}
+
+#ifdef USE_SENSOR
+void NSPanelLovelace::publish_latency_() {
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    auto *sensor = this->latency_sensors_[i];
+    auto &h = this->latency_tracker_.get_window(static_cast<latency_stage>(i));
+    if (sensor == nullptr || h.get_count() == 0) continue;
+    sensor->publish_state(h.get_percentile(95));
+  }
+  this->latency_tracker_.clear_window();
 }
+#endif
 
 void NSPanelLovelace::send_nextion_command_(const std::string &command) {
   ESP_LOGD(TAG, "Sending: %s", command.c_str());
@@ -1246,47 +1254,81 @@ void NSPanelLovelace::process_display_command_queue_() {
   // don't execute custom commands when the screen is updating - UI updates could spoil the upload
   if (this->is_updating_) return;
 #endif
-  // nothing to process
-  if (this->command_buffer_.empty() && this->command_queue_.empty()) return;
+  if (this->baud_switching_) return;
+  const uint8_t *frame;
+  size_t length;
+  uint32_t queued_at;
+  if (!this->command_queue_.pop(frame, length, millis(), &queued_at)) return;
+  ESP_LOGVV(TAG, "Command un-queued (size: %zu)", this->command_queue_.size());
+
+  ESP_LOGD(TAG, "TFT CMD OUT: %.*s", static_cast<int>(length - 6), frame + 4);
+  App.feed_wdt();
+  this->write_array(frame, length);
+
+  auto now = millis();
+  this->latency_tracker_.on_frame_sent(now);
+#ifdef USE_NSPANEL_TRAFFIC_CAPTURE
+  this->traffic_capture_.record(capture_type::sent, now, frame + 4, length - 6,
+    std::min<size_t>(this->command_queue_.size(), UINT16_MAX),
+    std::min<uint32_t>(now - queued_at, UINT16_MAX));
+#endif
+  this->command_pacer_.on_sent(now, length, this->parent_->get_baud_rate());
+}
 
-  // Store the command for later processing so the function can return quickly
-  if (!this->command_buffer_.empty()) {
-    this->command_queue_.push(this->command_buffer_);
-    ESP_LOGVV(TAG, "Command queued (size: %u)", this->command_queue_.size());
-    this->command_buffer_.clear();
-    return;
-  } else if (!this->command_queue_.empty()) {
-    // todo: can we use std::move? it changes the capacity of the buffer
-    this->command_buffer_.assign(this->command_queue_.front());
-    this->command_queue_.pop();
-    ESP_LOGVV(TAG, "Command un-queued (size: %u)", this->command_queue_.size());
-  }
-
-  ESP_LOGD(TAG, "TFT CMD OUT: %s", this->command_buffer_.c_str());
-  std::array<uint8_t, 4> crc_data = {
-    0x55, 0xBB, 
-    static_cast<uint8_t>(command_buffer_.length() & 0xFF),
-    static_cast<uint8_t>((command_buffer_.length() >> 8) & 0xFF)
-  };
-  auto crc = esphome::crc16(crc_data.data(), 4);
-  crc = esphome::crc16(
-    reinterpret_cast<const uint8_t *>(command_buffer_.c_str()),
-    command_buffer_.length(), crc);
+#ifdef USE_NSPANEL_TRAFFIC_CAPTURE
+void NSPanelLovelace::start_traffic_capture() {
+  if (this->traffic_capture_.start()) {
+    ESP_LOGI(TAG, "Traffic capture started (%zu bytes)", this->traffic_capture_.get_size());
+  } else {
+    ESP_LOGW(TAG, "Failed to allocate %zu bytes for the traffic capture", this->traffic_capture_.get_size());
+  }
+}
 
-  this->write_array(crc_data);
-  App.feed_wdt();
-  this->write_str(this->command_buffer_.c_str());
-  crc_data[0] = static_cast<uint8_t>(crc & 0xFF);
-  crc_data[1] = static_cast<uint8_t>((crc >> 8) & 0xFF);
-  this->write_array(crc_data.data(), 2);
-  
-  this->command_buffer_.clear();
-  this->command_last_sent_ = millis();
+void NSPanelLovelace::dump_traffic_capture() {
+  // hex bytes per log line, keeps the lines below the logger's line limit
+  static constexpr uint16_t bytes_per_line = 96;
+  ESP_LOGI(TAG, "Traffic capture: %" PRIu32 " records, %" PRIu32 " dropped",
+    this->traffic_capture_.get_record_count(),
+    this->traffic_capture_.get_dropped_count());
+  this->traffic_capture_.for_each([](const capture_record &r, const uint8_t *data) {
+    uint16_t n = std::min(r.length, bytes_per_line);
+    ESP_LOGI(TAG, "cap,%" PRIu32 ",%c,%u,%u,%s", r.time, static_cast<char>(r.type),
+      r.queue_depth, r.wait, esphome::format_hex(data, n).c_str());
+    for (uint16_t i = n; i < r.length; i += n) {
+      n = std::min<uint16_t>(r.length - i, bytes_per_line);
+      ESP_LOGI(TAG, "cap+,%s", esphome::format_hex(data + i, n).c_str());
+    }
+    App.feed_wdt();
+  });
 }
+#endif
 
-void NSPanelLovelace::send_buffered_command_() {
+void NSPanelLovelace::send_buffered_command_(command_priority priority) {
   if (this->command_buffer_.empty()) return;
-  this->process_display_command_queue_();
+#ifdef USE_NSPANEL_TFT_UPLOAD
+  // don't queue custom commands when the screen is updating - UI updates could spoil the upload
+  if (this->is_updating_) {
+    this->command_buffer_.clear();
+    return;
+  }
+#endif
+  // commands sent while handling a TFT event are responses to the user
+  if (this->command_priority_ < priority)
+    priority = this->command_priority_;
+
+  if (!this->display_shadow_.update(this->command_buffer_)) {
+    ESP_LOGVV(TAG, "Command skipped, already displayed");
+    this->command_buffer_.clear();
+    return;
+  }
+
+  // Store the command for later processing so the function can return quickly
+  if (this->command_queue_.push(this->command_buffer_, priority, millis())) {
+    ESP_LOGVV(TAG, "Command superseded (size: %zu)", this->command_queue_.size());
+  } else {
+    ESP_LOGVV(TAG, "Command queued (size: %zu)", this->command_queue_.size());
+  }
+  this->command_buffer_.clear();
 }
 
 void NSPanelLovelace::notify_on_screensaver(
@@ -1306,17 +1348,20 @@ void NSPanelLovelace::notify_on_screensaver(
     // hide the notification after a period of time
     this->set_timeout(timeout_ms, [this]() {
       if (!this->current_page_->is_type(page_type::screensaver)) return;
+      // re-sending the page is what clears the notification, it must not be skipped
+      this->display_shadow_.invalidate_page();
       this->render_screensaver();
     });
   }
 }
 
 void NSPanelLovelace::send_display_command(const std::string &command) {
+  // the shadow can't tell what a custom command changes on the TFT
+  this->display_shadow_.invalidate_page();
   this->command_buffer_.assign(command);
   this->send_buffered_command_();
 }
 
-#ifdef USE_NSPANEL_TFT_UPLOAD
 uint16_t NSPanelLovelace::recv_ret_string_(std::string &response, uint32_t timeout, bool recv_flag) {
 #ifdef FAKE_TFT_UPLOAD
   response.assign(1, 0x05); //ok response
@@ -1330,14 +1375,26 @@ uint16_t NSPanelLovelace::recv_ret_string_(std::string &response, uint32_t timeo
   bool ff_flag = false;
 
   start = millis();
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  auto uart_num = static_cast<uart_port_t>(
+    reinterpret_cast<uart::IDFUARTComponent*>(this->parent_)->get_hw_serial_number());
+#endif
 
   while ((timeout == 0 && this->available()) || millis() - start <= timeout) {
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+    // block in the driver until the next byte arrives instead of polling
+    if (uart_read_bytes(uart_num, &c, 1, pdMS_TO_TICKS(10)) != 1) {
+      App.feed_wdt();
+      continue;
+    }
+#else
     if (!this->available()) {
       App.feed_wdt();
       continue;
     }
 
     this->read_byte(&c);
+#endif
     if (c == 0xFF) {
       nr_of_ff_bytes++;
     } else {
@@ -1355,7 +1412,9 @@ uint16_t NSPanelLovelace::recv_ret_string_(std::string &response, uint32_t timeo
       }
     }
     App.feed_wdt();
+#if !(defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS))
     delay(2);
+#endif
 
     if (exit_flag || ff_flag) {
       break;
@@ -1370,7 +1429,7 @@ uint16_t NSPanelLovelace::recv_ret_string_(std::string &response, uint32_t timeo
 #endif
 }
 
-#ifdef USE_ARDUINO
+#if defined(USE_NSPANEL_TFT_UPLOAD) && defined(USE_ARDUINO)
 void NSPanelLovelace::set_reparse_mode_(bool active) {
   // if (this->reparse_mode_ == active) return;
 
@@ -1385,8 +1444,7 @@ void NSPanelLovelace::set_reparse_mode_(bool active) {
 
   this->reparse_mode_ = active;
 }
-#endif // USE_ARDUINO
-#endif // USE_NSPANEL_TFT_UPLOAD
+#endif // USE_NSPANEL_TFT_UPLOAD && USE_ARDUINO
 
 void NSPanelLovelace::init_display_(int baud_rate) {
   // hopefully on NSPanel it should always be an ESP32ArduinoUARTComponent instance
@@ -1394,9 +1452,175 @@ void NSPanelLovelace::init_display_(int baud_rate) {
   auto *uart = reinterpret_cast<uart::IDFUARTComponent*>(this->parent_);
 #else
   auto *uart = reinterpret_cast<uart::ESP32ArduinoUARTComponent*>(this->parent_);
+#endif
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  // the driver and its event queue are recreated
+  this->stop_rx_events_();
 #endif
   uart->set_baud_rate(baud_rate);
   uart->setup();
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  this->start_rx_events_();
+#endif
+}
+
+void NSPanelLovelace::set_uart_baud_rate_(uint32_t baud_rate) {
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  // the driver and its event queue are recreated
+  this->stop_rx_events_();
+#endif
+  this->parent_->set_baud_rate(baud_rate);
+  this->parent_->load_settings();
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  this->start_rx_events_();
+#endif
+}
+
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+void NSPanelLovelace::rx_event_task_(void *arg) {
+  auto *panel = static_cast<NSPanelLovelace *>(arg);
+  auto *uart = reinterpret_cast<uart::IDFUARTComponent*>(panel->parent_);
+  QueueHandle_t queue = *uart->get_uart_event_queue();
+  uart_event_t event;
+  while (true) {
+    if (xQueueReceive(queue, &event, portMAX_DELAY) != pdTRUE) continue;
+    switch (event.type) {
+    case UART_DATA:
+      panel->rx_pending_.store(true);
+      break;
+    case UART_FIFO_OVF:
+    case UART_BUFFER_FULL:
+    case UART_FRAME_ERR:
+    case UART_PARITY_ERR:
+      panel->rx_line_errors_++;
+      panel->rx_pending_.store(true);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void NSPanelLovelace::start_rx_events_() {
+  if (this->rx_task_ != nullptr) return;
+  auto *uart = reinterpret_cast<uart::IDFUARTComponent*>(this->parent_);
+  if (*uart->get_uart_event_queue() == nullptr) {
+    ESP_LOGW(TAG, "UART event queue not available, polling instead");
+    return;
+  }
+  this->rx_pending_.store(true);
+  // same core as the main loop, so the task is never running while it is deleted
+  if (xTaskCreatePinnedToCore(&NSPanelLovelace::rx_event_task_, "nspanel_rx", 2048,
+      this, 5, &this->rx_task_, xPortGetCoreID()) != pdPASS) {
+    ESP_LOGW(TAG, "Failed to start UART event task, polling instead");
+    this->rx_task_ = nullptr;
+  }
+}
+
+void NSPanelLovelace::stop_rx_events_() {
+  if (this->rx_task_ == nullptr) return;
+  vTaskDelete(this->rx_task_);
+  this->rx_task_ = nullptr;
+}
+
+void NSPanelLovelace::check_rx_line_errors_() {
+  uint32_t errors = this->rx_line_errors_.load();
+  if (errors == this->rx_line_errors_seen_) return;
+  ESP_LOGW(TAG, "UART receive errors: %" PRIu32, errors - this->rx_line_errors_seen_);
+  this->rx_line_errors_seen_ = errors;
+  this->display_shadow_.invalidate_page();
+  this->on_rx_error_();
+}
+#endif
+
+void NSPanelLovelace::negotiate_high_baud_rate_() {
+  if (this->high_baud_rate_ == 0 || this->high_baud_failed_ || this->baud_switching_) return;
+  if (this->parent_->get_baud_rate() == this->high_baud_rate_) return;
+
+  ESP_LOGI(TAG, "Switching TFT to %" PRIu32 " baud", this->high_baud_rate_);
+  this->baud_switching_ = true;
+  this->set_timeout("baud", 0, [this]() { this->switch_baud_rate_(this->high_baud_rate_); });
+}
+
+void NSPanelLovelace::switch_baud_rate_(uint32_t baud_rate) {
+  // Nextion instructions are only accepted outside of the protocol reparse mode
+  this->send_nextion_command_("DRAKJHSUYDGBNCJHGJKSHBDN");
+  this->send_nextion_command_("recmod=0");
+  this->send_nextion_command_("recmod=0");
+  // unlike 'bauds' this isn't persisted, the TFT starts at its default rate again after a reset
+  char command[16];
+  snprintf(command, sizeof(command), "baud=%" PRIu32, baud_rate);
+  this->send_nextion_command_(command);
+  this->flush();
+
+  this->set_timeout("baud", 50, [this, baud_rate]() {
+    this->set_uart_baud_rate_(baud_rate);
+
+    // anything received in between was sent at the old rate
+    uint8_t d;
+    while (this->available()) {
+      this->read_byte(&d);
+    }
+    this->decoder_.reset();
+
+    this->send_nextion_command_(""); // clears anything received by the TFT in between
+    this->send_nextion_command_("connect");
+    this->set_timeout("baud", 500, [this]() {
+      std::string response;
+      uint8_t d;
+      while (this->available()) {
+        this->read_byte(&d);
+        response += static_cast<char>(d);
+      }
+      this->send_nextion_command_("recmod=1");
+      this->on_baud_rate_switched_(response.find("comok") != std::string::npos);
+    });
+  });
+}
+
+void NSPanelLovelace::on_baud_rate_switched_(bool connected) {
+  if (!connected) {
+    ESP_LOGW(TAG, "TFT not responding at %" PRIu32 " baud", this->high_baud_rate_);
+    this->fall_back_baud_rate_();
+    return;
+  }
+  this->baud_errors_ = 0;
+  this->baud_switching_ = false;
+  ESP_LOGI(TAG, "TFT connected at %" PRIu32 " baud", this->parent_->get_baud_rate());
+}
+
+void NSPanelLovelace::fall_back_baud_rate_() {
+  ESP_LOGW(TAG, "Falling back to %" PRIu32 " baud", this->default_baud_rate_);
+  this->high_baud_failed_ = true;
+  this->baud_switching_ = true;
+  this->baud_fallbacks_++;
+  this->set_uart_baud_rate_(this->default_baud_rate_);
+  this->decoder_.reset();
+  // The TFT is in an unknown state, resetting it brings it back to its default rate
+  // and the 'startup' event will render the current state again
+  this->set_display_power_off_(true);
+  this->set_timeout("baud", 1000, [this]() {
+    this->set_display_power_off_(false);
+    this->baud_switching_ = false;
+  });
+}
+
+void NSPanelLovelace::on_rx_error_() {
+  if (this->baud_switching_ || this->parent_->get_baud_rate() == this->default_baud_rate_) return;
+#ifdef USE_NSPANEL_TFT_UPLOAD
+  if (this->is_updating_) return;
+#endif
+  // frames are getting lost at the high baud rate
+  auto now = millis();
+  if (this->baud_errors_ == 0 || (now - this->baud_errors_since_) > HIGH_BAUD_ERROR_WINDOW) {
+    this->baud_errors_since_ = now;
+    this->baud_errors_ = 0;
+  }
+  if (++this->baud_errors_ < HIGH_BAUD_ERROR_LIMIT) return;
+  ESP_LOGW(TAG, "Too many receive errors at %" PRIu32 " baud", this->parent_->get_baud_rate());
+  // not from within the decode loop, which would carry on with the reset decoder
+  this->baud_switching_ = true;
+  this->set_timeout("baud", 0, [this]() { this->fall_back_baud_rate_(); });
 }
 
 #ifdef USE_TIME
@@ -1560,7 +1784,7 @@ void NSPanelLovelace::update_datetime(const datetime_mode mode, const char *date
     this->command_buffer_
       .assign("date").append(1, SEPARATOR)
       .append(timestr);
-    this->send_buffered_command_();
+    this->send_buffered_command_(command_priority::background);
   }
 
   if ((mode & datetime_mode::time) == datetime_mode::time) {
@@ -1572,7 +1796,7 @@ void NSPanelLovelace::update_datetime(const datetime_mode mode, const char *date
     this->command_buffer_
       .assign("time").append(1, SEPARATOR)
       .append(now.strftime(timefmt));
-    this->send_buffered_command_();
+    this->send_buffered_command_(command_priority::background);
   }
 }
 
@@ -1635,49 +1859,107 @@ const std::string &NSPanelLovelace::try_replace_uuid_with_entity_id_(
 }
 
 void NSPanelLovelace::process_button_press_(
-    std::string &internal_id, 
-    const std::string &button_type, 
-    const std::string &value,
-    bool called_from_timeout) {
+    const str_span &internal_id,
+    const str_span &button_type,
+    const str_span &value) {
   if (button_type.empty()) return;
   
   // Throttle and filter processing of spammy actions to avoid command flooding
-  if (!called_from_timeout) {
-    if (internal_id == this->button_press_uuid_ && 
-        button_type == this->button_press_type_) {
-      this->button_press_value_ = value;
-      if (this->button_press_timeout_set_) return;
-      this->set_timeout("btnpr", 200, [this]() {
-        this->button_press_timeout_set_ = false;
-        ESP_LOGD(TAG, "Button press delayed: %s,%s,%s", 
-            this->button_press_uuid_.c_str(), this->button_press_type_.c_str(), 
-            this->button_press_value_.c_str());
-        this->process_button_press_(
-            this->button_press_uuid_, this->button_press_type_, 
-            this->button_press_value_, true);
-      });
-      this->button_press_timeout_set_ = true;
-      return;
-    } else if (this->button_press_timeout_set_) {
-      this->cancel_timeout("btnpr");
-      this->button_press_timeout_set_ = false;
-    }
-    this->button_press_uuid_ = internal_id;
-    this->button_press_type_ = button_type;
-  }
+  this->button_coalescer_.push(internal_id, button_type, value,
+    this->latency_tracker_.get_frame_at(), millis());
+}
 
+// Sorted by button type (strcmp order) so handlers can be found with a binary search,
+// a card adds its button types here along with a handler.
+constexpr NSPanelLovelace::button_handler NSPanelLovelace::BUTTON_HANDLERS[] = {
+  {button_type::onOff, &NSPanelLovelace::button_on_off_},
+  {button_type::armAway, &NSPanelLovelace::button_alarm_},
+  {button_type::armHome, &NSPanelLovelace::button_alarm_},
+  {button_type::armNight, &NSPanelLovelace::button_alarm_},
+  {button_type::armVacation, &NSPanelLovelace::button_alarm_},
+  {button_type::bExit, &NSPanelLovelace::button_exit_},
+  {button_type::brightnessSlider, &NSPanelLovelace::button_brightness_slider_},
+  {button_type::button, &NSPanelLovelace::button_button_},
+  {button_type::cardUnlockUnlock, &NSPanelLovelace::button_card_unlock_},
+  {button_type::colorTempSlider, &NSPanelLovelace::button_color_temp_slider_},
+  {button_type::colorWheel, &NSPanelLovelace::button_color_wheel_},
+  {button_type::disarm, &NSPanelLovelace::button_alarm_},
+  {button_type::down, &NSPanelLovelace::button_action_},
+  {button_type::hvacAction, &NSPanelLovelace::button_hvac_action_},
+  {button_type::mediaOnOff, &NSPanelLovelace::button_media_on_off_},
+  {button_type::mediaBack, &NSPanelLovelace::button_action_},
+  {button_type::mediaNext, &NSPanelLovelace::button_action_},
+  {button_type::mediaPause, &NSPanelLovelace::button_action_},
+  {button_type::mediaShuffle, &NSPanelLovelace::button_media_shuffle_},
+  {button_type::modeFanModes, &NSPanelLovelace::button_climate_mode_},
+  {button_type::modeInputSelect, &NSPanelLovelace::button_select_option_},
+  {button_type::modeLight, &NSPanelLovelace::button_light_effect_},
+  {button_type::modeMediaPlayer, &NSPanelLovelace::button_media_source_},
+  {button_type::modePresetModes, &NSPanelLovelace::button_climate_mode_},
+  {button_type::modeSelect, &NSPanelLovelace::button_select_option_},
+  {button_type::modeSwingModes, &NSPanelLovelace::button_climate_mode_},
+  {button_type::numberSet, &NSPanelLovelace::button_number_set_},
+  {button_type::opnSensorNotify, &NSPanelLovelace::button_open_sensors_},
+  {button_type::positionSlider, &NSPanelLovelace::button_position_slider_},
+  {button_type::sleepReached, &NSPanelLovelace::button_sleep_reached_},
+  {button_type::speakerSel, &NSPanelLovelace::button_speaker_sel_},
+  {button_type::stop, &NSPanelLovelace::button_action_},
+  {button_type::tempUpd, &NSPanelLovelace::button_temp_upd_},
+  {button_type::tempUpdHighLow, &NSPanelLovelace::button_temp_upd_high_low_},
+  {button_type::tiltClose, &NSPanelLovelace::button_action_},
+  {button_type::tiltOpen, &NSPanelLovelace::button_action_},
+  {button_type::tiltSlider, &NSPanelLovelace::button_tilt_slider_},
+  {button_type::tiltStop, &NSPanelLovelace::button_action_},
+  {button_type::timerCancel, &NSPanelLovelace::button_timer_},
+  {button_type::timerFinish, &NSPanelLovelace::button_timer_},
+  {button_type::timerPause, &NSPanelLovelace::button_timer_},
+  {button_type::timerStart, &NSPanelLovelace::button_timer_},
+  {button_type::up, &NSPanelLovelace::button_action_},
+  {button_type::volumeSlider, &NSPanelLovelace::button_volume_slider_},
+};
+const size_t NSPanelLovelace::BUTTON_HANDLER_COUNT =
+  sizeof(BUTTON_HANDLERS) / sizeof(BUTTON_HANDLERS[0]);
+
+// Buttons that only call a service on the entity
+static constexpr FrozenCharMap<const char *, 9> BUTTON_ACTION_MAP {{
+  std::pair<const char*, const char*>{button_type::up, ha_action_type::open_cover},
+  std::pair<const char*, const char*>{button_type::stop, ha_action_type::stop_cover},
+  std::pair<const char*, const char*>{button_type::down, ha_action_type::close_cover},
+  std::pair<const char*, const char*>{button_type::tiltOpen, ha_action_type::open_cover_tilt},
+  std::pair<const char*, const char*>{button_type::tiltStop, ha_action_type::stop_cover_tilt},
+  std::pair<const char*, const char*>{button_type::tiltClose, ha_action_type::close_cover_tilt},
+  std::pair<const char*, const char*>{button_type::mediaNext, ha_action_type::media_next_track},
+  std::pair<const char*, const char*>{button_type::mediaBack, ha_action_type::media_previous_track},
+  std::pair<const char*, const char*>{button_type::mediaPause, ha_action_type::media_play_pause},
+}};
+
+void NSPanelLovelace::handle_button_press_(const std::string &internal_id,
+    const std::string &button_type, const std::string &value, uint32_t received_at) {
+  static_assert(is_sorted_by_type(BUTTON_HANDLERS),
+    "BUTTON_HANDLERS must be sorted by button type");
   auto entity_type = get_entity_type(internal_id);
-  std::string& entity_id = internal_id;
+  const std::string &entity_id = entity_type == entity_type::uuid
+    ? this->try_replace_uuid_with_entity_id_(internal_id)
+    : internal_id;
   
   if (entity_type == entity_type::uuid) {
-    entity_id = this->try_replace_uuid_with_entity_id_(internal_id);
     ESP_LOGV(TAG, "Lookup %s -> %s", internal_id.c_str(), entity_id.c_str());
     entity_type = get_entity_type(entity_id);
     if (entity_type == nullptr) return;
   }
 
+  this->latency_tracker_.on_dispatch(received_at, millis());
+  auto handler = find_by_type(BUTTON_HANDLERS, button_type.c_str());
+  if (handler == nullptr) {
+    ESP_LOGV(TAG, "Unhandled button type '%s'", button_type.c_str());
+    return;
+  }
+  (this->*(handler->handler))({entity_type, entity_id, button_type, value});
+}
+
+void NSPanelLovelace::button_exit_(const button_press &press) {
   // Screen tapped when on the screensaver, show the default card or use the first card in the config.
-  if (internal_id == to_string(page_type::screensaver) && button_type == button_type::bExit) {
+  if (press.entity_id == to_string(page_type::screensaver)) {
     // todo: make a note of last used card
     //
     // config.get("screensaver.defaultCard")
@@ -1691,438 +1973,432 @@ void NSPanelLovelace::process_button_press_(
     this->render_page_(render_page_option::default_page);
     return;
   }
+  this->render_current_page_();
+}
 
-  if (button_type == button_type::sleepReached) {
-    // todo
-    // make a note of last used card then render screensaver
-    // _previous_card = _current_card;
-    // _current_card = action_type::screensaver;
-    // render_page_(_current_card);
-    this->render_page_(render_page_option::screensaver);
-    return;
-  }
+void NSPanelLovelace::button_sleep_reached_(const button_press &press) {
+  // todo
+  // make a note of last used card then render screensaver
+  // _previous_card = _current_card;
+  // _current_card = action_type::screensaver;
+  // render_page_(_current_card);
+  this->render_page_(render_page_option::screensaver);
+}
 
-  if (button_type == button_type::bExit) {
-    this->render_current_page_();
-    return;
-  }
+void NSPanelLovelace::button_action_(const button_press &press) {
+  const char *action = nullptr;
+  if (!try_get_value(BUTTON_ACTION_MAP, action, press.button_type)) return;
+  this->call_ha_service_(press.entity_type, action, press.entity_id);
+}
 
-  if (button_type == button_type::onOff) {
-    if (!value.empty()) {
-      this->call_ha_service_(
-        entity_type, 
-        value == "1" ? ha_action_type::turn_on : ha_action_type::turn_off, 
-        entity_id);
-    }
-  } 
-  // fan, number, input_number
-  else if (button_type == button_type::numberSet) {
-    if (entity_type == entity_type::fan) {
-      auto entity = this->get_entity_(entity_id);
-      if (entity == nullptr) return;
-      auto step = std::stof(
-        entity->get_attribute(ha_attr_type::percentage_step, "0"));
-      if (step > 100.0f) step = 100.0f;
-      auto val = std::stof(value) * step;
-      if (val > 100.0f) val = 100.0f;
-      auto pct = esphome::str_snprintf("%.6f", 11, val);
-      
-      this->call_ha_service_(
-        entity_type, 
-        ha_action_type::set_percentage, 
-        {{
-          {to_string(ha_attr_type::entity_id), entity_id},
-          {to_string(ha_attr_type::percentage), pct}
-        }});
-    } else {
-      this->call_ha_service_(
-        entity_type, 
-        ha_action_type::set_value, 
-        {{
-          {to_string(ha_attr_type::entity_id), entity_id},
-          {to_string(ha_attr_type::value), value}
-        }});
-    }
-  }
-  // cover and shutter cards
-  else if (button_type == button_type::up) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::open_cover, entity_id);
-  } else if (button_type == button_type::stop) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::stop_cover, entity_id);
-  } else if (button_type == button_type::down) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::close_cover, entity_id);
-  } else if (button_type == button_type::positionSlider) {
-    this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_cover_position, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::position), value}
-      }});
-  } else if (button_type == button_type::tiltOpen) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::open_cover_tilt, entity_id);
-  } else if (button_type == button_type::tiltStop) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::stop_cover_tilt, entity_id);
-  } else if (button_type == button_type::tiltClose) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::close_cover_tilt, entity_id);
-  } else if (button_type == button_type::tiltSlider) {
-    this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_cover_tilt_position, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::tilt_position), value}
-      }});
-  } else if (button_type == button_type::button) {
-    if (entity_type == entity_type::navigate ||
-        entity_type == entity_type::navigate_uuid) {
-      auto uuid = internal_id.substr(strlen(entity_type) + 1);
-      this->render_page_(this->find_page_index_by_uuid_(uuid));
-    } else if (
-        entity_type == entity_type::scene ||
-        entity_type == entity_type::script) {
-      this->call_ha_service_(
-        entity_type, ha_action_type::turn_on, entity_id);
-    } else if (
-        entity_type == entity_type::light ||
-        entity_type == entity_type::switch_ ||
-        entity_type == entity_type::input_boolean ||
-        entity_type == entity_type::automation ||
-        entity_type == entity_type::fan) {
-      this->call_ha_service_(
-        entity_type, ha_action_type::toggle, entity_id);
-    } else if (
-        entity_type == entity_type::button ||
-        entity_type == entity_type::input_button) {
-      this->call_ha_service_(
-        entity_type, ha_action_type::press, entity_id);
-    } else if (entity_type == entity_type::input_select) {
-      this->call_ha_service_(
-        entity_type, ha_action_type::select_next, entity_id);
-    } else if (entity_type == entity_type::vacuum) {
-      auto entity = this->get_entity_(entity_id);
-      if (entity == nullptr) return;
-      this->call_ha_service_(entity_type,
-        entity->is_state(entity_state::docked) 
-          ? ha_action_type::start 
-          : ha_action_type::return_to_base,
-        entity_id);
-    } else if (entity_type == entity_type::lock) {
-      auto entity = this->get_entity_(entity_id);
-      if (entity == nullptr) return;
-      this->call_ha_service_(entity_type,
-        entity->is_state(entity_state::locked) 
-          ? ha_action_type::unlock 
-          : ha_action_type::lock,
-        entity_id);
-    }
-  }
-  // media cards
-  else if (button_type == button_type::mediaNext) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::media_next_track, entity_id);
-  } else if (button_type == button_type::mediaBack) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::media_previous_track, entity_id);
-  } else if (button_type == button_type::mediaPause) {
-    this->call_ha_service_(
-      entity_type, ha_action_type::media_play_pause, entity_id);
-  } else if (button_type == button_type::mediaOnOff) {
-    auto entity = this->get_entity_(entity_id);
-    if (entity == nullptr) return;
-    this->call_ha_service_(
-      entity_type,
-      entity->is_state(entity_state::on) 
-        ? ha_action_type::turn_off 
-        : ha_action_type::turn_on,
-      entity_id);
-  } else if (button_type == button_type::mediaShuffle) {
-    auto entity = this->get_entity_(entity_id);
+void NSPanelLovelace::button_on_off_(const button_press &press) {
+  if (press.value.empty()) return;
+  this->call_ha_service_(
+    press.entity_type, 
+    press.value == "1" ? ha_action_type::turn_on : ha_action_type::turn_off, 
+    press.entity_id);
+}
+
+// fan, number, input_number
+void NSPanelLovelace::button_number_set_(const button_press &press) {
+  if (press.entity_type == entity_type::fan) {
+    auto entity = this->get_entity_(press.entity_id);
     if (entity == nullptr) return;
-    auto shuffle = entity->get_attribute(ha_attr_type::shuffle);
-    if (shuffle.empty()) return;
-    shuffle = shuffle == entity_state::off 
-      ? entity_state::on : entity_state::off;
-    this->call_ha_service_(
-      entity_type,
-      ha_action_type::shuffle_set,
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::shuffle), shuffle}
-      }});
-  } else if (button_type == button_type::volumeSlider) {
-    auto volume = esphome::str_snprintf("%.2f", 7, std::stoi(value) * 0.01f);
-    this->call_ha_service_(
-      entity_type,
-      ha_action_type::volume_set,
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::volume_level), volume}
-      }});
-  } else if (button_type == button_type::speakerSel) {
+    // percentages in hundredths
+    int32_t step = entity->
+      get_attribute_number(ha_attr_type::percentage_step, 0, 2);
+    if (step > 10000) step = 10000;
+    int32_t steps;
+    if (!parse_number(press.value, steps)) return;
+    // 64 bit so a bogus number of steps can't overflow, no step (0) still sends 0
+    int64_t val = static_cast<int64_t>(steps) * step;
+    if (val > 10000) val = 10000;
+    std::string pct;
+    append_fixed(pct, static_cast<int32_t>(val), 2);
+    
     this->call_ha_service_(
-      entity_type,
-      ha_action_type::select_source,
+      press.entity_type, 
+      ha_action_type::set_percentage, 
       {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::source), value}
+        {to_string(ha_attr_type::entity_id), press.entity_id},
+        {to_string(ha_attr_type::percentage), pct}
       }});
-  } else if (button_type == button_type::modeMediaPlayer) {
-    auto entity = this->get_entity_(entity_id);
-    if (entity == nullptr) return;
-    auto source_list_str = entity->get_attribute(ha_attr_type::source_list);
-    if (source_list_str.empty()) return;
-    std::vector<std::string> source_list;
-    split_str(',', source_list_str, source_list);
-    uint8_t index = stoi(value);
-    if (source_list.size() <= index) return;
+  } else {
     this->call_ha_service_(
-      entity_type,
-      ha_action_type::select_source,
+      press.entity_type, 
+      ha_action_type::set_value, 
       {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::source), source_list.at(index)}
+        {to_string(ha_attr_type::entity_id), press.entity_id},
+        {to_string(ha_attr_type::value), press.value}
       }});
   }
-  // light cards
-  else if (button_type == button_type::brightnessSlider) {
-    if (value.empty()) return;
-    this->call_ha_service_(
-      entity_type, 
-      ha_action_type::turn_on, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        // scale 0-100 to ha brightness range
-        {to_string(ha_attr_type::brightness), std::to_string(
-          static_cast<int>(
-            scale_value(std::stoi(value), {0, 100}, {0, 255})
-          ))}
-      }});
-  } else if (button_type == button_type::colorTempSlider) {
-    if (value.empty()) return;
-    auto entity = this->get_entity_(entity_id);
-    if (entity == nullptr) return;
-    auto &minstr = entity->get_attribute(ha_attr_type::min_mireds);
-    auto &maxstr = entity->get_attribute(ha_attr_type::max_mireds);
-    uint16_t min_mireds = minstr.empty() ? 153 : std::stoi(minstr);
-    uint16_t max_mireds = maxstr.empty() ? 500 : std::stoi(maxstr);
-    if (min_mireds >= max_mireds) {
-      ESP_LOGW(TAG, "min/max mired range invalid %i>=%i", min_mireds, max_mireds);
-      min_mireds = 153;
-      max_mireds = 500;
-    }
-    
-    this->call_ha_service_(
-      entity_type, 
-      ha_action_type::turn_on, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        // scale 0-100 from slider to color range of the light
-        {to_string(ha_attr_type::color_temp), std::to_string(
-          static_cast<int>(
-            scale_value(std::stoi(value), {0, 100},
-            {static_cast<double>(min_mireds), static_cast<double>(max_mireds)})
-          ))}
-      }});
-  } else if (button_type == button_type::colorWheel) {
-    if (value.empty()) return;
+}
 
-    std::vector<std::string> xy_tokens;
-    split_str('|', value, xy_tokens);
-    if (xy_tokens.size() != 3) return;
+// cover and shutter cards
+void NSPanelLovelace::button_position_slider_(const button_press &press) {
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::set_cover_position, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::position), press.value}
+    }});
+}
 
-    std::string rgb_str = to_string(
-        xy_to_rgb(
-          std::stod(xy_tokens[0]),
-          std::stod(xy_tokens[1]),
-          std::stod(xy_tokens[2])
-        ), ',', '[', ']');
+void NSPanelLovelace::button_tilt_slider_(const button_press &press) {
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::set_cover_tilt_position, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::tilt_position), press.value}
+    }});
+}
 
+void NSPanelLovelace::button_button_(const button_press &press) {
+  auto entity_type = press.entity_type;
+  auto &entity_id = press.entity_id;
+  if (entity_type == entity_type::navigate ||
+      entity_type == entity_type::navigate_uuid) {
+    auto uuid = entity_id.substr(strlen(entity_type) + 1);
+    this->render_page_(this->find_page_index_by_uuid_(uuid));
+  } else if (
+      entity_type == entity_type::scene ||
+      entity_type == entity_type::script) {
     this->call_ha_service_(
-      entity_type, 
-      ha_action_type::turn_on, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id}
-      }},
-      {{
-        {to_string(ha_attr_type::rgb_color), rgb_str}
-      }});
-  }
-  // thermo/climate card
-  else if (button_type == button_type::tempUpd) {
-    auto val = esphome::str_snprintf("%.1f", 6, std::stoi(value) * 0.1);
-    this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_temperature, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::temperature), val}
-      }});
-  } else if (button_type == button_type::tempUpdHighLow) {
-    std::vector<std::string> temp_values;
-    split_str('|', value, temp_values);
-    auto temp_high = esphome::str_snprintf(
-      "%.1f", 6, std::stoi(temp_values[0]) * 0.1);
-    auto temp_low = esphome::str_snprintf(
-      "%.1f", 6, std::stoi(temp_values[1]) * 0.1);
+      entity_type, ha_action_type::turn_on, entity_id);
+  } else if (
+      entity_type == entity_type::light ||
+      entity_type == entity_type::switch_ ||
+      entity_type == entity_type::input_boolean ||
+      entity_type == entity_type::automation ||
+      entity_type == entity_type::fan) {
     this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_temperature, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::target_temp_high), temp_high},
-        {to_string(ha_attr_type::target_temp_low), temp_low}
-      }});
-  } else if (button_type == button_type::hvacAction) {
+      entity_type, ha_action_type::toggle, entity_id);
+  } else if (
+      entity_type == entity_type::button ||
+      entity_type == entity_type::input_button) {
     this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_hvac_mode, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::hvac_mode), value}
-      }});
-  } else if (button_type == button_type::modePresetModes) {
-    auto entity = this->get_entity_(entity_id);
-    if (entity == nullptr) return;
-    auto &modes_str = entity->get_attribute(ha_attr_type::preset_modes);
-    if (modes_str.empty()) return;
-    std::vector<std::string> modes;
-    split_str(',', modes_str, modes);
-    auto &selected_mode = modes.at(std::stoi(value));
+      entity_type, ha_action_type::press, entity_id);
+  } else if (entity_type == entity_type::input_select) {
     this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_preset_mode, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::preset_mode), selected_mode}
-      }});
-  } else if (button_type == button_type::modeSwingModes) {
+      entity_type, ha_action_type::select_next, entity_id);
+  } else if (entity_type == entity_type::vacuum) {
     auto entity = this->get_entity_(entity_id);
     if (entity == nullptr) return;
-    auto &modes_str = entity->get_attribute(ha_attr_type::swing_modes);
-    if (modes_str.empty()) return;
-    std::vector<std::string> modes;
-    split_str(',', modes_str, modes);
-    auto &selected_mode = modes.at(std::stoi(value));
-    this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_swing_mode, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::swing_mode), selected_mode}
-      }});
-  } else if (button_type == button_type::modeFanModes) {
+    this->call_ha_service_(entity_type,
+      entity->is_state(entity_state::docked) 
+        ? ha_action_type::start 
+        : ha_action_type::return_to_base,
+      entity_id);
+  } else if (entity_type == entity_type::lock) {
     auto entity = this->get_entity_(entity_id);
     if (entity == nullptr) return;
-    auto &modes_str = entity->get_attribute(ha_attr_type::fan_modes);
-    if (modes_str.empty()) return;
-    std::vector<std::string> modes;
-    split_str(',', modes_str, modes);
-    auto &selected_mode = modes.at(std::stoi(value));
-    this->call_ha_service_(
-      entity_type, 
-      ha_action_type::set_fan_mode, 
-      {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::fan_mode), selected_mode}
-      }});
+    this->call_ha_service_(entity_type,
+      entity->is_state(entity_state::locked) 
+        ? ha_action_type::unlock 
+        : ha_action_type::lock,
+      entity_id);
   }
-  // alarm card
-  else if (
-      button_type == button_type::armHome ||
-      button_type == button_type::armAway ||
-      button_type == button_type::armNight ||
-      button_type == button_type::armVacation ||
-      button_type == button_type::disarm) {
-    auto action = std::string("alarm_").append(button_type);
-    if (value.empty()) {
-      this->call_ha_service_(entity_type, action.c_str(), entity_id);
-    } else {
-      this->call_ha_service_(
-        entity_type, action.c_str(), 
-        {{
-          {to_string(ha_attr_type::entity_id), entity_id},
-          {to_string(ha_attr_type::code), value}
-        }});
-    }
-  } else if (button_type == button_type::opnSensorNotify) {
-    auto entity = this->get_entity_(entity_id);
-    if (entity == nullptr) return;
-    auto &open_sensors_str = entity->get_attribute(ha_attr_type::open_sensors);
-    if (open_sensors_str.empty()) return;
-    std::string message;
-    message.reserve(open_sensors_str.size());
-    std::vector<std::string> open_sensors;
-    split_str(',', open_sensors_str, open_sensors);
-    // todo: Find a way to populate entitity 'friendly_name' without subscribing to all entities
-    for (auto &&sensor : open_sensors) {
-      message.append("- ").append(sensor).append("\r\n");
-    }
-    this->render_popup_notify_page_("", "", message);
+}
+
+// media cards
+void NSPanelLovelace::button_media_on_off_(const button_press &press) {
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  this->call_ha_service_(
+    press.entity_type,
+    entity->is_state(entity_state::on) 
+      ? ha_action_type::turn_off 
+      : ha_action_type::turn_on,
+    press.entity_id);
+}
+
+void NSPanelLovelace::button_media_shuffle_(const button_press &press) {
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  auto shuffle = entity->get_attribute(ha_attr_type::shuffle);
+  if (shuffle.empty()) return;
+  shuffle = shuffle == entity_state::off 
+    ? entity_state::on : entity_state::off;
+  this->call_ha_service_(
+    press.entity_type,
+    ha_action_type::shuffle_set,
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::shuffle), shuffle}
+    }});
+}
+
+void NSPanelLovelace::button_volume_slider_(const button_press &press) {
+  int32_t value;
+  if (!parse_number(press.value, value)) return;
+  std::string volume;
+  append_fixed(volume, value, 2);
+  this->call_ha_service_(
+    press.entity_type,
+    ha_action_type::volume_set,
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::volume_level), volume}
+    }});
+}
+
+void NSPanelLovelace::button_speaker_sel_(const button_press &press) {
+  this->call_ha_service_(
+    press.entity_type,
+    ha_action_type::select_source,
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::source), press.value}
+    }});
+}
+
+void NSPanelLovelace::button_media_source_(const button_press &press) {
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  auto &source_list = entity->get_attribute_list(ha_attr_type::source_list);
+  int32_t index;
+  if (!parse_number(press.value, index) || index < 0 ||
+      source_list.size() <= index) return;
+  this->call_ha_service_(
+    press.entity_type,
+    ha_action_type::select_source,
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::source), source_list.at(index)}
+    }});
+}
+
+// light cards
+void NSPanelLovelace::button_brightness_slider_(const button_press &press) {
+  int32_t value;
+  if (!parse_number(press.value, value)) return;
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::turn_on, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      // scale 0-100 to ha brightness range
+      {to_string(ha_attr_type::brightness), std::to_string(
+        static_cast<int>(
+          scale_value(value, {0, 100}, {0, 255})
+        ))}
+    }});
+}
+
+void NSPanelLovelace::button_color_temp_slider_(const button_press &press) {
+  int32_t value;
+  if (!parse_number(press.value, value)) return;
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  uint16_t min_mireds = entity->
+    get_attribute_number(ha_attr_type::min_mireds, 153);
+  uint16_t max_mireds = entity->
+    get_attribute_number(ha_attr_type::max_mireds, 500);
+  if (min_mireds >= max_mireds) {
+    ESP_LOGW(TAG, "min/max mired range invalid %i>=%i", min_mireds, max_mireds);
+    min_mireds = 153;
+    max_mireds = 500;
   }
-  // unlock card
-  else if (button_type == button_type::cardUnlockUnlock) {
-    if (!this->current_page_->is_type(page_type::cardUnlock)) return;
-    // todo
+  
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::turn_on, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      // scale 0-100 from slider to color range of the light
+      {to_string(ha_attr_type::color_temp), std::to_string(
+        static_cast<int>(
+          scale_value(value, {0, 100},
+          {static_cast<double>(min_mireds), static_cast<double>(max_mireds)})
+        ))}
+    }});
+}
+
+void NSPanelLovelace::button_color_wheel_(const button_press &press) {
+  if (press.value.empty()) return;
+
+  std::vector<std::string> xy_tokens;
+  split_str('|', press.value, xy_tokens);
+  if (xy_tokens.size() != 3) return;
+  int32_t x, y, wh;
+  if (!parse_number(xy_tokens[0], x) ||
+      !parse_number(xy_tokens[1], y) ||
+      !parse_number(xy_tokens[2], wh)) return;
+
+  std::string rgb_str = to_string(
+      xy_to_rgb(x, y, wh), ',', '[', ']');
+
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::turn_on, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id}
+    }},
+    {{
+      {to_string(ha_attr_type::rgb_color), rgb_str}
+    }});
+}
+
+void NSPanelLovelace::button_light_effect_(const button_press &press) {
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  auto &effects = entity->get_attribute_list(ha_attr_type::effect_list);
+  int32_t index;
+  if (!parse_number(press.value, index) || index < 0 ||
+      effects.size() <= index) return;
+  this->call_ha_service_(
+    press.entity_type,
+    ha_action_type::turn_on,
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::effect), effects.at(index)}
+    }});
+}
+
+// thermo/climate card
+void NSPanelLovelace::button_temp_upd_(const button_press &press) {
+  // the TFT sends tenths of a degree
+  int32_t value;
+  if (!parse_number(press.value, value)) return;
+  std::string val;
+  append_fixed(val, value, 1);
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::set_temperature, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::temperature), val}
+    }});
+}
+
+void NSPanelLovelace::button_temp_upd_high_low_(const button_press &press) {
+  std::vector<std::string> temp_values;
+  split_str('|', press.value, temp_values);
+  int32_t high, low;
+  if (temp_values.size() < 2 ||
+      !parse_number(temp_values[0], high) ||
+      !parse_number(temp_values[1], low)) return;
+  std::string temp_high, temp_low;
+  append_fixed(temp_high, high, 1);
+  append_fixed(temp_low, low, 1);
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::set_temperature, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::target_temp_high), temp_high},
+      {to_string(ha_attr_type::target_temp_low), temp_low}
+    }});
+}
+
+void NSPanelLovelace::button_hvac_action_(const button_press &press) {
+  this->call_ha_service_(
+    press.entity_type, 
+    ha_action_type::set_hvac_mode, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::hvac_mode), press.value}
+    }});
+}
+
+void NSPanelLovelace::button_climate_mode_(const button_press &press) {
+  ha_attr_type modes_attr, mode_attr;
+  const char *action;
+  if (press.button_type == button_type::modePresetModes) {
+    modes_attr = ha_attr_type::preset_modes;
+    mode_attr = ha_attr_type::preset_mode;
+    action = ha_action_type::set_preset_mode;
+  } else if (press.button_type == button_type::modeSwingModes) {
+    modes_attr = ha_attr_type::swing_modes;
+    mode_attr = ha_attr_type::swing_mode;
+    action = ha_action_type::set_swing_mode;
+  } else {
+    modes_attr = ha_attr_type::fan_modes;
+    mode_attr = ha_attr_type::fan_mode;
+    action = ha_action_type::set_fan_mode;
   }
-  // select & input_select
-  else if (
-      button_type == button_type::modeInputSelect ||
-      button_type == button_type::modeSelect) {
-    auto entity = this->get_entity_(entity_id);
-    if (entity == nullptr) return;
-    auto options_str = entity->get_attribute(ha_attr_type::options);
-    if (options_str.empty()) return;
-    std::vector<std::string> options;
-    split_str(',', options_str, options);
-    uint8_t index = stoi(value);
-    if (options.size() <= index) return;
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  auto &modes = entity->get_attribute_list(modes_attr);
+  int32_t index;
+  if (!parse_number(press.value, index) || index < 0 ||
+      modes.size() <= index) return;
+  auto selected_mode = modes.at(index);
+  this->call_ha_service_(
+    press.entity_type, 
+    action, 
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(mode_attr), selected_mode}
+    }});
+}
+
+// alarm card
+void NSPanelLovelace::button_alarm_(const button_press &press) {
+  auto action = std::string("alarm_").append(press.button_type);
+  if (press.value.empty()) {
+    this->call_ha_service_(press.entity_type, action.c_str(), press.entity_id);
+  } else {
     this->call_ha_service_(
-      entity_type,
-      ha_action_type::select_option,
+      press.entity_type, action.c_str(), 
       {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::option), options.at(index)}
+        {to_string(ha_attr_type::entity_id), press.entity_id},
+        {to_string(ha_attr_type::code), press.value}
       }});
   }
-  // light
-  else if (button_type == button_type::modeLight) {
-    auto entity = this->get_entity_(entity_id);
-    if (entity == nullptr) return;
-    auto effects_str = entity->get_attribute(ha_attr_type::effect_list);
-    if (effects_str.empty()) return;
-    std::vector<std::string> effects;
-    split_str(',', effects_str, effects);
-    uint8_t index = stoi(value);
-    if (effects.size() <= index) return;
-    this->call_ha_service_(
-      entity_type,
-      ha_action_type::turn_on,
+}
+
+void NSPanelLovelace::button_open_sensors_(const button_press &press) {
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  auto &open_sensors = entity->get_attribute_list(ha_attr_type::open_sensors);
+  if (open_sensors.empty()) return;
+  std::string message;
+  // todo: Find a way to populate entitity 'friendly_name' without subscribing to all entities
+  for (uint16_t i = 0; i < open_sensors.size(); i++) {
+    message.append("- ").append(open_sensors.at(i)).append("\r\n");
+  }
+  this->render_popup_notify_page_("", "", message);
+}
+
+// unlock card
+void NSPanelLovelace::button_card_unlock_(const button_press &press) {
+  if (!this->current_page_->is_type(page_type::cardUnlock)) return;
+  // todo
+}
+
+// select & input_select
+void NSPanelLovelace::button_select_option_(const button_press &press) {
+  auto entity = this->get_entity_(press.entity_id);
+  if (entity == nullptr) return;
+  auto &options = entity->get_attribute_list(ha_attr_type::options);
+  int32_t index;
+  if (!parse_number(press.value, index) || index < 0 ||
+      options.size() <= index) return;
+  this->call_ha_service_(
+    press.entity_type,
+    ha_action_type::select_option,
+    {{
+      {to_string(ha_attr_type::entity_id), press.entity_id},
+      {to_string(ha_attr_type::option), options.at(index)}
+    }});
+}
+
+// timer card
+void NSPanelLovelace::button_timer_(const button_press &press) {
+  std::string service(press.button_type);
+  service[5] = '.';
+  if (press.value.empty()) {
+    this->call_ha_service_(service, press.entity_id);
+  } else {
+    this->call_ha_service_(service, 
       {{
-        {to_string(ha_attr_type::entity_id), entity_id},
-        {to_string(ha_attr_type::effect), effects.at(index)}
+        {to_string(ha_attr_type::entity_id), press.entity_id},
+        {to_string(ha_attr_type::duration), press.value}
       }});
   }
-  // timer card
-  else if (esphome::str_startswith(button_type, entity_type::timer)) {
-    std::string service(button_type);
-    service[5] = '.';
-    if (value.empty()) {
-      this->call_ha_service_(service, entity_id);
-    } else {
-      this->call_ha_service_(service, 
-        {{
-          {to_string(ha_attr_type::entity_id), entity_id},
-          {to_string(ha_attr_type::duration), value}
-        }});
-    }
-  }
 }
 
 StatefulPageItem* NSPanelLovelace::get_page_item_(const std::string &uuid) {
@@ -2139,16 +2415,7 @@ StatefulPageItem* NSPanelLovelace::get_page_item_(const std::string &uuid) {
 }
 
 Entity* NSPanelLovelace::get_entity_(const std::string &entity_id) {
-  // use cached version if possible
-  if (this->cached_entity_ != nullptr && 
-      this->cached_entity_->get_entity_id() == entity_id) 
-    return this->cached_entity_;
-
-  for (auto& entity : this->entities_) {
-    if (entity->get_entity_id() != entity_id) continue;
-    return this->cached_entity_ = entity.get();
-  }
-  return this->cached_entity_ = nullptr;
+  return this->entities_.get(entity_id);
 }
 
 void NSPanelLovelace::call_ha_service_(
@@ -2178,10 +2445,13 @@ void NSPanelLovelace::call_ha_service_(
   resp.service = service;
 
   auto it = data.find(to_string(ha_attr_type::entity_id));
-  if (it == data.end())
+  if (it != data.end()) {
     ESP_LOGD(TAG, "Call HA: %s -> %s", resp.service.c_str(), it->second.c_str());
-  else
+    this->button_coalescer_.on_service_call(it->second, millis());
+    this->latency_tracker_.on_service_call(it->second, millis());
+  } else {
     ESP_LOGD(TAG, "Call HA: %s", resp.service.c_str());
+  }
 
   for (auto &it : data) {
     api::HomeassistantServiceMap kv;
@@ -2199,91 +2469,111 @@ void NSPanelLovelace::call_ha_service_(
   api::global_api_server->send_homeassistant_service_call(resp);
 }
 
-void NSPanelLovelace::on_entity_state_update_(std::string entity_id, std::string state) {
-  this->on_entity_attribute_update_(entity_id, to_string(ha_attr_type::state), state);
-}
-void NSPanelLovelace::on_entity_attribute_update_(std::string entity_id, std::string attr, std::string attr_value) {
-  auto entity = this->get_entity_(entity_id);
+void NSPanelLovelace::on_entity_update_(entity_handle_t handle, ha_attr_type ha_attr, const std::string &value) {
+  auto entity = this->entities_.get(handle);
   if (entity == nullptr) return;
-  auto ha_attr = to_ha_attr(attr);
-  if (ha_attr == ha_attr_type::unknown) return;
+  auto &entity_id = entity->get_entity_id();
+  this->button_coalescer_.on_state_update(entity_id, millis());
+  this->latency_tracker_.on_state_update(entity_id, millis());
 
   if (ha_attr == ha_attr_type::state) {
-    entity->set_state(attr_value);
+    entity->set_state(value);
   } else {
-    entity->set_attribute(ha_attr, attr_value);
+    entity->set_attribute(ha_attr, value);
   }
 
   ESP_LOGD(TAG, "HA update: %s %s='%s'",
-    entity_id.c_str(), attr.c_str(), 
+    entity_id.c_str(), to_string(ha_attr), 
     ha_attr == ha_attr_type::state
-      ? entity->get_state().c_str()
+      ? entity->get_state()
       : entity->get_attribute(ha_attr).c_str());
 
-  // if (this->force_current_page_update_) return;
-
-  // If there are lots of entity attributes that update within a short time
-  // then this will queue lots of commands unnecessarily.
-  // This re-schedules updates every time one happens within a 200ms period.
-  this->set_timeout(entity_id, 200, [this, entity_id] () {
-    if (this->force_current_page_update_) return;
-    if (this->current_page_ == nullptr) return;
+  // rendered with the other changes of the current frame
+  this->render_scheduler_.mark_dirty(handle, millis());
+}
 
-    if (this->screensaver_ != nullptr && 
-        this->current_page_->is_type(page_type::screensaver)) {
-      force_current_page_update_ = 
-        this->screensaver_->should_render_status_update(entity_id);
-      return;
+void NSPanelLovelace::render_dirty_entities_() {
+  if (!this->page_index_.is_built()) this->build_page_index_();
+  if (!this->force_current_page_update_ && this->current_page_ != nullptr) {
+    for (auto handle : this->render_scheduler_.get_dirty()) {
+      if (!this->should_render_entity_update_(handle)) continue;
+      this->force_current_page_update_ = true;
+      break;
     }
+  }
+  this->render_scheduler_.end_frame(millis());
+}
 
-    // re-render only if the entity is on the currently active card
-    // todo: this doesnt account for popup pages
-    for (auto &item : this->current_page_->get_items()) {
+void NSPanelLovelace::build_page_index_() {
+  this->page_index_.clear();
+  for (auto &page : this->pages_) {
+    for (auto &item : page->get_items()) {
       auto stateful_item = page_item_cast<StatefulPageItem>(item.get());
       if (stateful_item == nullptr) continue;
-      
-      if (stateful_item->get_entity_id() == entity_id) {
-        force_current_page_update_ = true;
-        return;
-      }
-    }
-
-    auto entity_type = get_entity_type(entity_id);
-    // Thermo cards don't have items to check, only a single thermo entity
-    // render updates when climate entitites are updated
-    if (entity_type == entity_type::climate &&
-        this->current_page_->is_type(page_type::cardThermo)) {
-      force_current_page_update_ = true;
-      return;
+      this->page_index_.add(stateful_item->get_entity()->get_handle(), page.get());
     }
-    else if (entity_type == entity_type::media_player &&
-        this->current_page_->is_type(page_type::cardMedia)) {
-      force_current_page_update_ = true;
-      return;
+    // these cards show a single entity that isn't one of their items
+    Entity *entity = nullptr;
+    if (page->is_type(page_type::cardThermo)) {
+      entity = page_cast<ThermoCard>(page.get())->get_entity();
+    } else if (page->is_type(page_type::cardMedia)) {
+      entity = page_cast<MediaCard>(page.get())->get_entity();
+    } else if (page->is_type(page_type::cardAlarm)) {
+      entity = page_cast<AlarmCard>(page.get())->get_entity();
     }
-    else if (entity_type == entity_type::alarm_control_panel &&
-        this->current_page_->is_type(page_type::cardAlarm)) {
-      force_current_page_update_ = true;
-      return;
+    if (entity != nullptr) this->page_index_.add(entity->get_handle(), page.get());
+  }
+  if (this->screensaver_ != nullptr) {
+    for (auto icon : {this->screensaver_->get_icon_left(), this->screensaver_->get_icon_right()}) {
+      if (icon != nullptr) this->page_index_.add_status_icon(icon->get_entity()->get_handle());
     }
-    
-    // todo: implement popup page checks too
-    // if (this->popup_page_current_uuid_ == item->get_uuid()) {
-    //   this->render_popup_page_update_(item);
-    // } else if (this->popup_page_current_uuid_.empty()) {
-    //   this->render_item_update_(this->current_page_);
-    // }
-  });
+  }
+  this->page_index_.build(this->entities_.size());
+}
+
+void NSPanelLovelace::size_frame_pool_() {
+  // entityUpd of the page with the most/longest items is by far the largest frame
+  size_t max_length = 0;
+  for (auto &page : this->pages_) {
+    max_length = std::max(max_length, page->render(this->command_buffer_).length());
+  }
+  this->command_buffer_.clear();
+  this->command_queue_.set_max_frame_length(max_length + 6);
+}
+
+bool NSPanelLovelace::should_render_entity_update_(entity_handle_t handle) const {
+  if (this->screensaver_ != nullptr && 
+      this->current_page_->is_type(page_type::screensaver)) {
+    return this->page_index_.is_status_icon(handle);
+  }
+
+  // an open popup covers the page, which is rendered again when the popup closes
+  if (!this->popup_page_current_uuid_.empty()) {
+    return this->cached_page_item_ != nullptr &&
+      this->cached_page_item_->get_entity()->get_handle() == handle;
+  }
+
+  return this->page_index_.is_on_page(handle, this->current_page_);
 }
 
 void NSPanelLovelace::send_weather_update_command_() {
   if (this->current_page_ != this->screensaver_)
     return;
   this->screensaver_->render(this->command_buffer_);
-  this->send_buffered_command_();
+  this->send_buffered_command_(command_priority::background);
+}
+
+void NSPanelLovelace::on_weather_update_(ha_attr_type attr, std::string &value) {
+  switch (attr) {
+    case ha_attr_type::state: this->on_weather_state_update_(value); break;
+    case ha_attr_type::temperature: this->on_weather_temperature_update_(value); break;
+    case ha_attr_type::temperature_unit: this->on_weather_temperature_unit_update_(value); break;
+    case ha_attr_type::forecast: this->on_weather_forecast_update_(value); break;
+    default: break;
+  }
 }
 
-void NSPanelLovelace::on_weather_state_update_(std::string entity_id, std::string state) {
+void NSPanelLovelace::on_weather_state_update_(const std::string &state) {
   if (this->screensaver_ == nullptr) return;
   auto item = this->screensaver_->get_item<WeatherItem>(0);
   if (item == nullptr) return;
@@ -2291,7 +2581,7 @@ void NSPanelLovelace::on_weather_state_update_(std::string entity_id, std::strin
   this->send_weather_update_command_();
 }
 
-void NSPanelLovelace::on_weather_temperature_update_(std::string entity_id, std::string temperature) {
+void NSPanelLovelace::on_weather_temperature_update_(std::string &temperature) {
   if (this->screensaver_ == nullptr) return;
   auto item = this->screensaver_->get_item<WeatherItem>(0);
   if (item == nullptr) return;
@@ -2299,14 +2589,14 @@ void NSPanelLovelace::on_weather_temperature_update_(std::string entity_id, std:
   this->send_weather_update_command_();
 }
 
-void NSPanelLovelace::on_weather_temperature_unit_update_(std::string entity_id, std::string temperature_unit) {
+void NSPanelLovelace::on_weather_temperature_unit_update_(std::string &temperature_unit) {
   if (this->screensaver_ == nullptr) return;
   WeatherItem::temperature_unit = std::move(temperature_unit);
   this->screensaver_->set_items_render_invalid();
   this->send_weather_update_command_();
 }
 
-void NSPanelLovelace::on_weather_forecast_update_(std::string entity_id, std::string forecast_json) {
+void NSPanelLovelace::on_weather_forecast_update_(std::string &forecast_json) {
   if (this->screensaver_ == nullptr) return;
   // todo: check if we are on the screensaver otherwise don't update
   // todo: implement color updates: "color~background~tTime~timeAMPM~tDate~tMainText~tForecast1~tForecast2~tForecast3~tForecast4~tForecast1Val~tForecast2Val~tForecast3Val~tForecast4Val~bar~tMainTextAlt2~tTimeAdd"
@@ -2,10 +2,11 @@
 
 #include "defines.h"
 
+#include <array>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <map>
-#include <queue>
 #include <stdint.h>
 #include <utility>
 #include <vector>
@@ -16,6 +17,9 @@
 #include "esphome/core/preferences.h"
 #include "esphome/components/uart/uart.h"
 #include "esphome/components/api/custom_api_device.h"
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
 
 #ifdef USE_ESP_IDF
 #include <driver/gpio.h>
@@ -23,6 +27,10 @@
 #ifdef USE_NSPANEL_TFT_UPLOAD
 #include <esp_http_client.h>
 #endif
+#ifdef USE_NSPANEL_UART_EVENTS
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
 #else
 #ifdef USE_NSPANEL_TFT_UPLOAD
 #include <HTTPClient.h>
@@ -35,13 +43,25 @@
 #include "esphome/components/time/real_time_clock.h"
 #endif
 
+#include "button_coalescer.h"
+#include "command_pacer.h"
+#include "command_queue.h"
 #include "config.h"
+#include "display_shadow.h"
 #include "entity.h"
+#include "entity_page_index.h"
+#include "entity_registry.h"
 #include "types.h"
 #include "helpers.h"
+#include "latency_tracker.h"
 #include "page_base.h"
 #include "card_base.h"
 #include "pages.h"
+#include "render_scheduler.h"
+#include "tft_decoder.h"
+#ifdef USE_NSPANEL_TRAFFIC_CAPTURE
+#include "traffic_capture.h"
+#endif
 
 namespace esphome {
 namespace nspanel_lovelace {
@@ -79,6 +99,7 @@ public:
         this->pages_.push_back(page);
     else
       this->pages_.insert(this->pages_.begin() + position, page);
+    this->page_index_.invalidate();
 
     // set the screensaver if the page is a screensaver page
     // todo: refactor so this isn't required here
@@ -107,6 +128,15 @@ public:
   void set_display_inactive_dim(uint8_t inactive);
   // Note: this can be used without parameters to update the display without changing the levels
   void set_display_dim(uint8_t inactive = UINT8_MAX, uint8_t active = UINT8_MAX);
+  void set_command_pacing(command_pacing_t policy) { this->command_pacer_.set_policy(policy); }
+  // Maximum display updates per second caused by entity changes
+  void set_render_frame_rate(uint8_t frame_rate) { this->render_scheduler_.set_frame_rate(frame_rate); }
+  void set_entity_subscriptions(const entity_subscription *subscriptions, size_t count) {
+    this->entity_subscriptions_ = subscriptions;
+    this->entity_subscription_count_ = count;
+  }
+  // Baud rate to switch the TFT to after it has started, 0 to keep the UART baud rate
+  void set_high_baud_rate(uint32_t baud_rate) { this->high_baud_rate_ = baud_rate; }
   void set_weather_entity_id(const std::string &weather_entity_id) { this->weather_entity_id_ = weather_entity_id; }
 
   void render_screensaver() { this->render_page_(render_page_option::screensaver); }
@@ -123,21 +153,43 @@ public:
    */
   void soft_reset_display() {
     // this->send_nextion_command_("rest"); // only for stock FW
+    this->set_display_power_off_(true);
 #ifdef USE_ESP_IDF
-    gpio_set_level(GPIO_NUM_4, 1);
     vTaskDelay(pdMS_TO_TICKS(1000));
-    gpio_set_level(GPIO_NUM_4, 0);
 #else
-    digitalWrite(GPIO4, 1);
     delay(1000);
-    digitalWrite(GPIO4, 0);
 #endif
+    this->set_display_power_off_(false);
   }
 
   float get_setup_priority() const override { return setup_priority::DATA; }
 
   void dump_config() override;
 
+  uint32_t get_rx_dropped_bytes() const { return this->decoder_.get_dropped_bytes(); }
+  uint32_t get_rx_crc_errors() const { return this->decoder_.get_crc_errors(); }
+
+#ifdef USE_SENSOR
+  // Publishes the 95th percentile of the stage's latency (ms) every LATENCY_PUBLISH_INTERVAL
+  void set_latency_sensor(latency_stage stage, sensor::Sensor *sensor) {
+    this->latency_sensors_[static_cast<uint8_t>(stage)] = sensor;
+  }
+#endif
+
+#ifdef USE_NSPANEL_TRAFFIC_CAPTURE
+  void set_traffic_capture_size(size_t size) { this->traffic_capture_.set_size(size); }
+  /**
+   * Record the frames received from and sent to the TFT,
+   * previous records are cleared.
+   */
+  void start_traffic_capture();
+  void stop_traffic_capture() { this->traffic_capture_.stop(); }
+  /**
+   * Write the recorded frames to the log (see TrafficCapture for the format)
+   */
+  void dump_traffic_capture();
+#endif
+
   void add_incoming_msg_callback(std::function<void(std::string)> callback) { this->incoming_msg_callback_.add(std::move(callback)); }
 
 #ifdef TEST_DEVICE_MODE
@@ -159,37 +211,121 @@ protected:
   ESPPreferenceObject pref_;
 
   void init_display_(int baud_rate);
-#ifdef USE_NSPANEL_TFT_UPLOAD
+  void set_uart_baud_rate_(uint32_t baud_rate);
   uint16_t recv_ret_string_(std::string &response, uint32_t timeout, bool recv_flag);
-#ifdef USE_ARDUINO
+#if defined(USE_NSPANEL_TFT_UPLOAD) && defined(USE_ARDUINO)
   void set_reparse_mode_(bool active);
 #endif
+  // The baud rate handshake and fallback are requested from the decode loop but run
+  // from the scheduler, loop() leaves the UART alone while baud_switching_ is set
+  void negotiate_high_baud_rate_();
+  void switch_baud_rate_(uint32_t baud_rate);
+  void on_baud_rate_switched_(bool connected);
+  void fall_back_baud_rate_();
+  void on_rx_error_();
+  void set_display_power_off_(bool off) {
+#ifdef USE_ESP_IDF
+    gpio_set_level(GPIO_NUM_4, off ? 1 : 0);
+#else
+    digitalWrite(GPIO4, off ? 1 : 0);
 #endif
+  }
   void send_nextion_command_(const std::string &command);
 
-  void subscribe_homeassistant_state_attr(
-      void (NSPanelLovelace::*callback)(std::string, std::string, std::string),
-      std::string entity_id, std::string attribute) {
-    auto f = std::bind(callback, this, entity_id, attribute, std::placeholders::_1);
-    api::global_api_server->
-      subscribe_home_assistant_state(entity_id, optional<std::string>(attribute), f);
+  // Subscribes to the state (ha_attr_type::state) or an attribute of the entity,
+  // the callback only captures the handle and attribute so it fits into std::function without allocating
+  // (a std::bind with copies of the entity id and attribute name took a 68 byte block, plus the
+  // strings longer than 15 chars, for each subscription)
+  void subscribe_entity_(Entity &entity, ha_attr_type attr) {
+    if (attr != ha_attr_type::state) entity.add_attribute_slot(attr);
+    auto handle = entity.get_handle();
+    this->subscribe_ha_state_(entity.get_entity_id(), attr,
+      [this, handle, attr](std::string value) { this->on_entity_update_(handle, attr, value); });
+  }
+  // Same for the screensaver weather, CustomAPIDevice::subscribe_homeassistant_state() would
+  // bind a copy of the entity id and the member function pointer which has to be allocated
+  void subscribe_weather_(ha_attr_type attr) {
+    this->subscribe_ha_state_(this->weather_entity_id_, attr,
+      [this, attr](std::string value) { this->on_weather_update_(attr, value); });
   }
+  void subscribe_ha_state_(const std::string &entity_id, ha_attr_type attr,
+      std::function<void(std::string)> &&callback) {
+    this->subscription_count_++;
+    api::global_api_server->subscribe_home_assistant_state(entity_id,
+      attr == ha_attr_type::state ? optional<std::string>() : optional<std::string>(to_string(attr)),
+      std::move(callback));
+  }
+
+  // The generated subscriptions of the entity, or the defaults for its type if there are none
+  ha_attr_mask_t get_entity_subscriptions_(const Entity &entity) const;
 
-  bool process_data_();
+  void process_data_();
   size_t find_page_index_by_uuid_(const std::string &uuid) const;
   const std::string &try_replace_uuid_with_entity_id_(const std::string &uuid_or_entity_id);
   void process_command_(const std::string &message);
-  void send_buffered_command_();
+  void send_buffered_command_(command_priority priority = command_priority::page);
   void process_display_command_queue_();
-  void process_button_press_(std::string &entity_id,
-    const std::string &button_type,
-    const std::string &value = "", bool called_from_timeout = false);
+  void process_button_press_(const str_span &internal_id,
+    const str_span &button_type, const str_span &value = {});
+  void handle_button_press_(const std::string &internal_id,
+    const std::string &button_type, const std::string &value, uint32_t received_at);
+
+  struct button_press {
+    const char *entity_type;
+    const std::string &entity_id;
+    const std::string &button_type;
+    const std::string &value;
+  };
+  typedef void (NSPanelLovelace::*button_handler_t)(const button_press &press);
+  struct button_handler {
+    const char *type;
+    button_handler_t handler;
+  };
+  // Handler for each button type, sorted by type, the size follows from the definition
+  // and BUTTON_HANDLER_COUNT makes it known outside of nspanel_lovelace.cpp
+  static const button_handler BUTTON_HANDLERS[];
+  static const size_t BUTTON_HANDLER_COUNT;
+
+  void button_exit_(const button_press &press);
+  void button_sleep_reached_(const button_press &press);
+  void button_action_(const button_press &press);
+  void button_on_off_(const button_press &press);
+  void button_number_set_(const button_press &press);
+  void button_position_slider_(const button_press &press);
+  void button_tilt_slider_(const button_press &press);
+  void button_button_(const button_press &press);
+  void button_media_on_off_(const button_press &press);
+  void button_media_shuffle_(const button_press &press);
+  void button_volume_slider_(const button_press &press);
+  void button_speaker_sel_(const button_press &press);
+  void button_media_source_(const button_press &press);
+  void button_brightness_slider_(const button_press &press);
+  void button_color_temp_slider_(const button_press &press);
+  void button_color_wheel_(const button_press &press);
+  void button_light_effect_(const button_press &press);
+  void button_temp_upd_(const button_press &press);
+  void button_temp_upd_high_low_(const button_press &press);
+  void button_hvac_action_(const button_press &press);
+  void button_climate_mode_(const button_press &press);
+  void button_alarm_(const button_press &press);
+  void button_open_sensors_(const button_press &press);
+  void button_card_unlock_(const button_press &press);
+  void button_select_option_(const button_press &press);
+  void button_timer_(const button_press &press);
+
   StatefulPageItem* get_page_item_(const std::string &uuid);
   Entity* get_entity_(const std::string &entity_id);
 
   void render_page_(size_t index);
   void render_page_(render_page_option d);
   void render_current_page_();
+  // Re-renders what the entity changes since the last frame affect
+  void render_dirty_entities_();
+  // Maps the entities to the pages and screensaver status icons showing them
+  void build_page_index_();
+  // Sizes the TX frame slots from the largest page of the configuration
+  void size_frame_pool_();
+  bool should_render_entity_update_(entity_handle_t handle) const;
   void render_item_update_(Page *page);
   void render_popup_notify_page_(const std::string &internal_id,
     const std::string &heading, const std::string &message, uint16_t timeout = 0U,
@@ -230,44 +366,82 @@ protected:
     const std::string& service,
     const std::map<std::string, std::string> &data,
     const std::map<std::string, std::string> &data_template = {});
-  void on_entity_state_update_(std::string entity_id, std::string state);
-  void on_entity_attribute_update_(
-    std::string entity_id, std::string attr_name, std::string attr_value);
-
-  void on_weather_state_update_(std::string entity_id, std::string state);
-  void on_weather_temperature_update_(std::string entity_id, std::string temperature);
-  void on_weather_temperature_unit_update_(std::string entity_id, std::string temperature_unit);
-  void on_weather_forecast_update_(std::string entity_id, std::string forecast_json);
+  void on_entity_update_(entity_handle_t handle, ha_attr_type attr, const std::string &value);
+
+  void on_weather_update_(ha_attr_type attr, std::string &value);
+  void on_weather_state_update_(const std::string &state);
+  void on_weather_temperature_update_(std::string &temperature);
+  void on_weather_temperature_unit_update_(std::string &temperature_unit);
+  void on_weather_forecast_update_(std::string &forecast_json);
   void send_weather_update_command_();
   std::string weather_entity_id_;
   std::string language_;
 
-  std::queue<std::string> command_queue_;
-  unsigned long command_last_sent_ = 0;
-
-  bool button_press_timeout_set_ = false;
-  std::string button_press_uuid_;
-  std::string button_press_type_;
-  std::string button_press_value_;
+  CommandQueue command_queue_;
+  CommandPacer command_pacer_;
+  DisplayShadow display_shadow_;
+  // lane used for commands sent from the current context
+  command_priority command_priority_ = command_priority::page;
+  std::string last_incoming_msg_;
+  uint32_t last_incoming_msg_time_ = 0;
+
+  ButtonCoalescer button_coalescer_;
+  LatencyTracker latency_tracker_;
+  RenderScheduler render_scheduler_;
+#ifdef USE_SENSOR
+  void publish_latency_();
+  std::array<sensor::Sensor *, LATENCY_STAGE_COUNT> latency_sensors_{};
+#endif
 
   uint8_t current_page_index_ = 0;
   std::string popup_page_current_uuid_;
   Page* current_page_ = nullptr;
   bool force_current_page_update_ = false;
   Screensaver* screensaver_ = nullptr;
-  std::vector<std::shared_ptr<Entity>> entities_;
+  EntityRegistry entities_;
   std::vector<std::shared_ptr<Page>> pages_;
   std::vector<std::shared_ptr<StatefulPageItem>> stateful_page_items_;
+  EntityPageIndex page_index_;
+  const entity_subscription *entity_subscriptions_ = nullptr;
+  size_t entity_subscription_count_ = 0;
+  uint16_t subscription_count_ = 0;
+  // internal heap used by the subscriptions in setup()
+  uint32_t subscription_heap_ = 0;
   StatefulPageItem* cached_page_item_ = nullptr;
-  Entity* cached_entity_ = nullptr;
 
   CallbackManager<void(std::string)> incoming_msg_callback_;
 
-  std::vector<uint8_t> buffer_;
+  TFTDecoder decoder_;
+  std::string rx_message_;
+  uint32_t rx_last_received_ = 0;
+#ifdef USE_NSPANEL_TRAFFIC_CAPTURE
+  TrafficCapture traffic_capture_;
+#endif
+#if defined(USE_ESP_IDF) && defined(USE_NSPANEL_UART_EVENTS)
+  // Waits for events from the UART driver so loop() doesn't have to poll it
+  static void rx_event_task_(void *arg);
+  void start_rx_events_();
+  void stop_rx_events_();
+  void check_rx_line_errors_();
+  TaskHandle_t rx_task_ = nullptr;
+  // set by the event task when data has been received
+  std::atomic<bool> rx_pending_{true};
+  // data lost in the driver (overflows) or received at the wrong baud rate
+  std::atomic<uint32_t> rx_line_errors_{0};
+  uint32_t rx_line_errors_seen_ = 0;
+#endif
   std::string command_buffer_;
 
-#ifdef USE_NSPANEL_TFT_UPLOAD
   uint32_t default_baud_rate_ = 0;
+  uint32_t high_baud_rate_ = 0;
+  // set when the high baud rate didn't work, it's not tried again until the next boot
+  bool high_baud_failed_ = false;
+  bool baud_switching_ = false;
+  uint8_t baud_errors_ = 0;
+  uint32_t baud_errors_since_ = 0;
+  uint32_t baud_fallbacks_ = 0;
+
+#ifdef USE_NSPANEL_TFT_UPLOAD
   uint32_t update_baud_rate_ = 115200;
   bool is_updating_ = false;
   bool reparse_mode_ = false;
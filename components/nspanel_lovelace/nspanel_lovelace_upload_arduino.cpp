@@ -143,6 +143,9 @@ bool NSPanelLovelace::upload_tft(const std::string &url) {
   this->set_reparse_mode_(false);
 
   this->is_updating_ = true;
+  // the upload sets its own baud rate
+  this->cancel_timeout("baud");
+  this->baud_switching_ = false;
 
   HTTPClient http;
   http.setTimeout(15000);  // Yes 15 seconds.... Helps 8266s along
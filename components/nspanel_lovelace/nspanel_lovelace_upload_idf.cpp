@@ -216,6 +216,9 @@ bool NSPanelLovelace::upload_tft(const std::string &url /*, uint32_t baud_rate*/
   }
 
   this->is_updating_ = true;
+  // the upload sets its own baud rate
+  this->cancel_timeout("baud");
+  this->baud_switching_ = false;
 
   std::string recv_res;
   if (Configuration::get_model() != nspanel_model_t::unknown) {
@@ -231,8 +234,7 @@ bool NSPanelLovelace::upload_tft(const std::string &url /*, uint32_t baud_rate*/
     uint32_t baudrates[7] = {115200,19200,9600,57600,38400,4800,2400};
     bool found = false;
     for (uint8_t i = 0; i < (sizeof(baudrates) / sizeof(uint32_t)); i++) {
-      this->parent_->set_baud_rate(baudrates[i]);
-      this->parent_->load_settings();
+      this->set_uart_baud_rate_(baudrates[i]);
       uint8_t d;
       while (this->available()) {
         App.feed_wdt();
@@ -264,8 +266,7 @@ bool NSPanelLovelace::upload_tft(const std::string &url /*, uint32_t baud_rate*/
         "Failed to establish TFT connection, reverting to %" PRIu32
         " baud and attempting update anyway",
         this->default_baud_rate_);
-      this->parent_->set_baud_rate(this->default_baud_rate_);
-      this->parent_->load_settings();
+      this->set_uart_baud_rate_(this->default_baud_rate_);
       // return this->upload_end_(false);
     }
   }
@@ -361,8 +362,7 @@ bool NSPanelLovelace::upload_tft(const std::string &url /*, uint32_t baud_rate*/
   this->send_nextion_command_(command);
 
   if (this->parent_->get_baud_rate() != this->update_baud_rate_) {
-    this->parent_->set_baud_rate(this->update_baud_rate_);
-    this->parent_->load_settings();
+    this->set_uart_baud_rate_(this->update_baud_rate_);
   }
 
   ESP_LOGD(TAG, "Waiting for upgrade response");
@@ -439,8 +439,7 @@ bool NSPanelLovelace::upload_end_(bool successful) {
   // Make sure we are running with the configured baud rate
   // so we can communicate normally with the TFT again
   if (this->parent_->get_baud_rate() != this->default_baud_rate_) {
-    this->parent_->set_baud_rate(this->default_baud_rate_);
-    this->parent_->load_settings();
+    this->set_uart_baud_rate_(this->default_baud_rate_);
   }
   this->soft_reset_display();
   // todo: Why do we need to reset the ESP after a TFT update?
@@ -214,6 +214,7 @@ void StatefulPageItem::on_entity_type_change(const char *type) {
   this->icon_value_overridden_ = false;
 
   this->set_on_state_callback_(type);
+  this->entity_->set_subscriber_attributes(this, this->get_subscribed_attributes_(type));
 
   this->set_render_invalid();
 
@@ -223,7 +224,7 @@ void StatefulPageItem::on_entity_type_change(const char *type) {
   }
 }
 
-void StatefulPageItem::on_entity_state_change(const std::string &state) {
+void StatefulPageItem::on_entity_state_change(const char *state) {
   this->set_render_invalid();
 
   if (this->on_state_callback_) {
@@ -284,6 +285,18 @@ void StatefulPageItem::set_on_state_callback_(const char *type) {
   }
 }
 
+ha_attr_mask_t StatefulPageItem::get_subscribed_attributes_(const char *type) const {
+  // this class only needs to react to the following attributes,
+  // the state callbacks of these types pick the icon by device class
+  if (type == entity_type::sensor ||
+      type == entity_type::binary_sensor ||
+      type == entity_type::cover)
+    return ha_attr_mask(ha_attr_type::state, ha_attr_type::device_class);
+  if (type == entity_type::media_player)
+    return ha_attr_mask(ha_attr_type::state, ha_attr_type::media_content_type);
+  return ha_attr_mask(ha_attr_type::state);
+}
+
 std::string &StatefulPageItem::render_(std::string &buffer) {
   // type~
   buffer.append(this->render_type_).append(1, SEPARATOR);
@@ -367,24 +380,22 @@ void StatefulPageItem::state_cover_fn(StatefulPageItem *me) {
 }
 
 void StatefulPageItem::state_climate_fn(StatefulPageItem *me) {
-  auto &state = me->get_state();
-
   if (!me->icon_value_overridden_) {
     me->icon_value_ = get_value_or_default(CLIMATE_ICON_MAP,
-      state, icon_t::checkbox_marked_circle);
+      me->get_state(), icon_t::checkbox_marked_circle);
   }
 
   if (!me->icon_color_overridden_) {
     me->icon_color_ = 64512U;
-    if (state == entity_state::auto_ ||
-        state == entity_state::heat_cool) {
+    if (me->is_state(entity_state::auto_) ||
+        me->is_state(entity_state::heat_cool)) {
       me->icon_color_ = 1024U;
-    } else if (state == entity_state::off ||
-        state == entity_state::fan_only) {
+    } else if (me->is_state(entity_state::off) ||
+        me->is_state(entity_state::fan_only)) {
       me->icon_color_ = 35921U;
-    } else if (state == entity_state::cool) {
+    } else if (me->is_state(entity_state::cool)) {
       me->icon_color_ = 11487U;
-    } else if (state == entity_state::dry) {
+    } else if (me->is_state(entity_state::dry)) {
       me->icon_color_ = 60897U;
     }
   }
@@ -189,18 +189,24 @@ public:
   void accept(PageItemVisitor& visitor) override;
 
   void on_entity_type_change(const char *type) override;
-  void on_entity_state_change(const std::string &state) override;
+  void on_entity_state_change(const char *state) override;
   void on_entity_attribute_change(ha_attr_type attr, const std::string &value) override;
 
   bool is_type(const char *type) const { return this->entity_->is_type(type); }
   const char *get_type() const { return this ->entity_->get_type(); }
   const std::string &get_entity_id() const { return this->entity_->get_entity_id(); }
+  bool is_state(const char *state) const { return this->entity_->is_state(state); }
   bool is_state(const std::string &state) const { return this->entity_->is_state(state); }
-  const std::string &get_state() const { return this->entity_->get_state(); }
+  const char *get_state() const { return this->entity_->get_state(); }
+  const char *get_state_translation() const { return this->entity_->get_state_translation(); }
   const std::string &get_attribute(
       ha_attr_type attr, const std::string &default_value = "") const {
     return this->entity_->get_attribute(attr, default_value);
   }
+  int32_t get_attribute_number(
+      ha_attr_type attr, int32_t default_value, uint8_t decimals = 0) const {
+    return this->entity_->get_attribute_number(attr, default_value, decimals);
+  }
   Entity* get_entity() const { return this->entity_.get(); }
 
 protected:
@@ -210,6 +216,8 @@ protected:
   const char *render_type_;
 
   virtual void set_on_state_callback_(const char *type);
+  // The state and attributes the item needs to be notified about for entities of 'type'
+  virtual ha_attr_mask_t get_subscribed_attributes_(const char *type) const;
 
   static void state_on_off_fn(StatefulPageItem *me);
   static void state_binary_sensor_fn(StatefulPageItem *me);
@@ -24,6 +24,8 @@ public:
 
   void set_icon_left(std::shared_ptr<StatusIconItem> left_icon);
   void set_icon_right(std::shared_ptr<StatusIconItem> right_icon);
+  StatusIconItem *get_icon_left() const { return this->left_icon.get(); }
+  StatusIconItem *get_icon_right() const { return this->right_icon.get(); }
   bool should_render_status_update(const std::string &entity_id = "") {
     if (this->left_icon && (entity_id.empty() ||
         this->left_icon->get_entity_id() == entity_id)) {
@@ -0,0 +1,40 @@
+#include "render_scheduler.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+void RenderScheduler::set_frame_rate(uint8_t frame_rate) {
+  if (frame_rate == 0) frame_rate = RENDER_DEFAULT_FRAME_RATE;
+  this->frame_interval_ = 1000u / frame_rate;
+}
+
+bool RenderScheduler::mark_dirty(entity_handle_t handle, uint32_t now) {
+  if (handle == INVALID_ENTITY_HANDLE) return false;
+  this->update_count_++;
+  size_t word = handle / 32;
+  uint32_t bit = 1UL << (handle % 32);
+  if (word >= this->dirty_bits_.size()) this->dirty_bits_.resize(word + 1);
+  if (this->dirty_bits_[word] & bit) return false;
+  this->dirty_bits_[word] |= bit;
+  if (this->dirty_.empty()) this->first_dirty_ = now;
+  this->dirty_.push_back(handle);
+  return true;
+}
+
+bool RenderScheduler::is_frame_due(uint32_t now) const {
+  return !this->dirty_.empty() &&
+    now - this->first_dirty_ >= RENDER_FRAME_SETTLE &&
+    now - this->last_frame_ >= this->frame_interval_;
+}
+
+void RenderScheduler::end_frame(uint32_t now) {
+  for (auto handle : this->dirty_) {
+    this->dirty_bits_[handle / 32] &= ~(1UL << (handle % 32));
+  }
+  this->dirty_.clear();
+  this->last_frame_ = now;
+  this->frame_count_++;
+}
+
+}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "config.h"
+#include "entity.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// Collects the entities that changed since the last frame, so the display is
+// updated at most once per frame however many updates Home Assistant sends.
+//
+// A frame starts once the frame interval has passed since the previous one and
+// the first change has had RENDER_FRAME_SETTLE ms for the rest of its burst
+// (HA sends the state and every attribute separately) to arrive.
+class RenderScheduler {
+public:
+  void set_frame_rate(uint8_t frame_rate);
+  uint16_t get_frame_interval() const { return this->frame_interval_; }
+
+  // Records the change, returns false if the entity already changed in this frame
+  bool mark_dirty(entity_handle_t handle, uint32_t now);
+  bool has_pending() const { return !this->dirty_.empty(); }
+  bool is_frame_due(uint32_t now) const;
+  // The entities that changed, in the order of their first change
+  const std::vector<entity_handle_t> &get_dirty() const { return this->dirty_; }
+  // Clears the changed entities and starts the next frame interval
+  void end_frame(uint32_t now);
+
+  uint32_t get_frame_count() const { return this->frame_count_; }
+  uint32_t get_update_count() const { return this->update_count_; }
+
+protected:
+  std::vector<entity_handle_t> dirty_;
+  // one bit per entity handle
+  std::vector<uint32_t> dirty_bits_;
+  uint16_t frame_interval_ = 1000u / RENDER_DEFAULT_FRAME_RATE;
+  uint32_t last_frame_ = 0;
+  uint32_t first_dirty_ = 0;
+  uint32_t frame_count_ = 0;
+  uint32_t update_count_ = 0;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
@@ -0,0 +1,186 @@
+#include "tft_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+static constexpr uint8_t STARTUP_SEQ[] = {0x00,0x00,0x00,0xFF,0xFF,0xFF};
+static constexpr uint8_t READY_SEQ[] = {0x88,0xFF,0xFF,0xFF};
+
+uint8_t *TFTDecoder::write_ptr(size_t &length) {
+  // one slot is always kept free to tell a full ring apart from an empty one
+  if (this->head_ >= this->tail_) {
+    length = RING_SIZE - this->head_ - (this->tail_ == 0 ? 1 : 0);
+  } else {
+    length = this->tail_ - this->head_ - 1;
+  }
+  return &this->ring_[this->head_];
+}
+
+void TFTDecoder::commit(size_t length) {
+  this->head_ = (this->head_ + length) & MASK;
+}
+
+void TFTDecoder::resync() {
+  if (this->state_ == state::header1) return;
+  this->dropped_bytes_++;
+  this->tail_ = (this->tail_ + 1) & MASK;
+  this->cursor_ = this->tail_;
+  this->state_ = state::header1;
+}
+
+void TFTDecoder::reset() {
+  this->head_ = this->tail_ = this->cursor_ = 0;
+  this->state_ = state::header1;
+  this->data_ = nullptr;
+  this->length_ = 0;
+}
+
+tft_frame_type TFTDecoder::decode() {
+  while (this->cursor_ != this->head_) {
+    if (this->state_ == state::payload) {
+      // skip over the payload in contiguous chunks, the checksum is verified once the frame is complete
+      uint16_t available = this->head_ > this->cursor_
+        ? this->head_ - this->cursor_
+        : RING_SIZE - this->cursor_;
+      uint16_t n = std::min(available, this->payload_remaining_);
+      this->cursor_ = (this->cursor_ + n) & MASK;
+      this->payload_remaining_ -= n;
+      if (this->payload_remaining_ == 0)
+        this->state_ = state::crc_lo;
+      continue;
+    }
+
+    if (this->state_ == state::header1) {
+      uint8_t b = this->ring_[this->cursor_];
+      if (b != 0x55 && b != STARTUP_SEQ[0] && b != READY_SEQ[0])
+        return this->skip_garbage_();
+    }
+
+    uint8_t b = this->ring_[this->cursor_];
+    this->cursor_ = (this->cursor_ + 1) & MASK;
+
+    switch (this->state_) {
+    case state::header1:
+      // Byte 0: HEADER1 (always 0x55)
+      if (b == 0x55) {
+        this->state_ = state::header2;
+      // Nextion Startup event
+      } else if (b == STARTUP_SEQ[0]) {
+        this->state_ = state::startup;
+        this->matched_ = 1;
+      // Nextion Ready event
+      // note: This event can be removed by custom firmware and may never occur
+      } else {
+        this->state_ = state::ready;
+        this->matched_ = 1;
+      }
+      break;
+    case state::header2:
+      // Byte 1: HEADER2 (always 0xBB)
+      if (b != 0xBB)
+        return this->discard_(tft_frame_type::invalid);
+      this->state_ = state::length_lo;
+      break;
+    // Byte 2 & 3 - length (little endian)
+    case state::length_lo:
+      this->payload_length_ = b;
+      this->state_ = state::length_hi;
+      break;
+    case state::length_hi:
+      this->payload_length_ |= static_cast<uint16_t>(b) << 8;
+      // a corrupt length would otherwise stall decoding until that much garbage has been received
+      if (this->payload_length_ > MAX_PAYLOAD_SIZE)
+        return this->discard_(tft_frame_type::invalid);
+      this->payload_remaining_ = this->payload_length_;
+      this->state_ = this->payload_length_ == 0 ? state::crc_lo : state::payload;
+      break;
+    // Last two bytes: CRC (little endian)
+    case state::crc_lo:
+      this->crc_ = b;
+      this->state_ = state::crc_hi;
+      break;
+    case state::crc_hi:
+      this->crc_ |= static_cast<uint16_t>(b) << 8;
+      return this->complete_message_();
+    case state::startup:
+      if (b != STARTUP_SEQ[this->matched_])
+        return this->discard_(tft_frame_type::invalid);
+      if (++this->matched_ == sizeof(STARTUP_SEQ))
+        return this->complete_(tft_frame_type::startup);
+      break;
+    case state::ready:
+      if (b != READY_SEQ[this->matched_])
+        return this->discard_(tft_frame_type::invalid);
+      if (++this->matched_ == sizeof(READY_SEQ))
+        return this->complete_(tft_frame_type::ready);
+      break;
+    default:
+      break;
+    }
+  }
+  return tft_frame_type::none;
+}
+
+tft_frame_type TFTDecoder::complete_(tft_frame_type type) {
+  this->length_ = (this->cursor_ - this->tail_) & MASK;
+  this->data_ = this->view_(this->tail_, this->length_);
+  this->tail_ = this->cursor_;
+  this->state_ = state::header1;
+  return type;
+}
+
+tft_frame_type TFTDecoder::discard_(tft_frame_type type) {
+  this->length_ = (this->cursor_ - this->tail_) & MASK;
+  this->data_ = this->view_(this->tail_, this->length_);
+  // the bytes following the first one stay in the ring and are decoded again
+  this->dropped_bytes_++;
+  this->tail_ = (this->tail_ + 1) & MASK;
+  this->cursor_ = this->tail_;
+  this->state_ = state::header1;
+  return type;
+}
+
+tft_frame_type TFTDecoder::skip_garbage_() {
+  while (this->cursor_ != this->head_) {
+    uint8_t b = this->ring_[this->cursor_];
+    if (b == 0x55 || b == STARTUP_SEQ[0] || b == READY_SEQ[0]) break;
+    this->cursor_ = (this->cursor_ + 1) & MASK;
+  }
+  this->dropped_bytes_ += (this->cursor_ - this->tail_) & MASK;
+  return this->complete_(tft_frame_type::invalid);
+}
+
+tft_frame_type TFTDecoder::complete_message_() {
+  // checksum covers the header, length and payload
+  uint16_t crc_length = 4 + this->payload_length_;
+  uint16_t first = std::min<uint16_t>(crc_length, RING_SIZE - this->tail_);
+  uint16_t crc = esphome::crc16(&this->ring_[this->tail_], first);
+  if (first < crc_length)
+    crc = esphome::crc16(&this->ring_[0], crc_length - first, crc);
+
+  if (crc != this->crc_) {
+    this->crc_errors_++;
+    return this->discard_(tft_frame_type::crc_mismatch);
+  }
+
+  this->length_ = this->payload_length_;
+  this->data_ = this->view_((this->tail_ + 4) & MASK, this->length_);
+  this->tail_ = this->cursor_;
+  this->state_ = state::header1;
+  return tft_frame_type::message;
+}
+
+const uint8_t *TFTDecoder::view_(uint16_t pos, uint16_t length) {
+  uint16_t first = RING_SIZE - pos;
+  if (length <= first) return &this->ring_[pos];
+  std::memcpy(this->frame_, &this->ring_[pos], first);
+  std::memcpy(this->frame_ + first, this->ring_, length - first);
+  return this->frame_;
+}
+
+}
+}
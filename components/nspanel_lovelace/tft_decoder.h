@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+enum class tft_frame_type : uint8_t {
+  none,         // no complete frame buffered yet
+  message,      // 0x55 0xBB custom protocol frame, payload in data()
+  startup,      // Nextion startup sequence
+  ready,        // Nextion ready sequence
+  crc_mismatch, // complete frame with invalid checksum, raw frame in data()
+  invalid       // unexpected data or aborted frame, raw bytes in data()
+};
+
+// Resumable decoder for data received from the TFT.
+// Bytes are written in bulk into a fixed ring buffer and consumed by an
+// explicit state machine, so partially received frames are kept across
+// loop() calls without re-parsing what was already seen.
+// When a frame turns out to be corrupt only its first byte is dropped and the
+// remaining bytes are rescanned for the next preamble, so a valid frame that
+// follows (or is hidden inside) garbage is not lost.
+//
+// usage:
+//   size_t length;
+//   uint8_t *ptr = decoder.write_ptr(length);
+//   // fill up to 'length' bytes at 'ptr'
+//   decoder.commit(filled);
+//   while ((type = decoder.decode()) != tft_frame_type::none) { ... }
+class TFTDecoder {
+public:
+  // must be a power of 2
+  static constexpr uint16_t RING_SIZE = 512u;
+  // header (4) + payload + crc (2) must fit in the ring (minus one sentinel slot)
+  static constexpr uint16_t MAX_PAYLOAD_SIZE = RING_SIZE - 7u;
+
+  // Contiguous free space at the write position.
+  uint8_t *write_ptr(size_t &length);
+  // Mark 'length' bytes at write_ptr() as received.
+  void commit(size_t length);
+
+  // Advance the state machine over all received bytes, returns as soon as
+  // a frame has been completed (or discarded).
+  // data() and length() are only valid until the next call to decode() or commit().
+  tft_frame_type decode();
+  const uint8_t *data() const { return this->data_; }
+  uint16_t length() const { return this->length_; }
+
+  // Number of received bytes not yet consumed by a completed frame.
+  uint16_t pending() const { return (this->head_ - this->tail_) & MASK; }
+  // Abort the partially received frame (e.g. after a timeout) and rescan
+  // its bytes for the next preamble on the following decode() call.
+  void resync();
+  void reset();
+
+  uint32_t get_dropped_bytes() const { return this->dropped_bytes_; }
+  uint32_t get_crc_errors() const { return this->crc_errors_; }
+
+protected:
+  static constexpr uint16_t MASK = RING_SIZE - 1u;
+  static_assert((RING_SIZE & MASK) == 0, "RING_SIZE must be a power of 2");
+
+  enum class state : uint8_t {
+    header1, header2, length_lo, length_hi, payload, crc_lo, crc_hi,
+    startup, ready
+  };
+
+  tft_frame_type complete_(tft_frame_type type);
+  tft_frame_type complete_message_();
+  // Report the current frame as corrupt, drop its first byte and rewind to rescan the rest.
+  tft_frame_type discard_(tft_frame_type type);
+  // Skip bytes that can't start a frame.
+  tft_frame_type skip_garbage_();
+  // Returns a contiguous pointer to 'length' ring bytes starting at 'pos',
+  // copying into frame_ if the range wraps around the end of the ring.
+  const uint8_t *view_(uint16_t pos, uint16_t length);
+
+  uint8_t ring_[RING_SIZE];
+  uint8_t frame_[RING_SIZE];
+  uint16_t head_ = 0;   // write position
+  uint16_t tail_ = 0;   // start of the frame currently being decoded
+  uint16_t cursor_ = 0; // next byte to decode
+  state state_ = state::header1;
+  uint16_t matched_ = 0;          // bytes matched of a startup/ready sequence
+  uint16_t payload_length_ = 0;
+  uint16_t payload_remaining_ = 0;
+  uint16_t crc_ = 0;
+
+  uint32_t dropped_bytes_ = 0;
+  uint32_t crc_errors_ = 0;
+
+  const uint8_t *data_ = nullptr;
+  uint16_t length_ = 0;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
@@ -0,0 +1,89 @@
+#include "traffic_capture.h"
+
+#include <algorithm>
+#include <cstring>
+#include "helpers.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// longer frames are truncated
+static constexpr uint16_t CAPTURE_MAX_DATA = 1024u;
+
+TrafficCapture::~TrafficCapture() {
+  if (this->buffer_ != nullptr) SpiRamAllocator().deallocate(this->buffer_);
+}
+
+bool TrafficCapture::start() {
+  if (this->buffer_ == nullptr && this->size_ > 0) {
+    // the scratch area holds the data of a wrapped record while it is read back
+    this->buffer_ = static_cast<uint8_t *>(
+      SpiRamAllocator().allocate(this->size_ + CAPTURE_MAX_DATA));
+    this->scratch_ = this->buffer_ == nullptr ? nullptr : this->buffer_ + this->size_;
+  }
+  if (this->buffer_ == nullptr) return false;
+  this->head_ = this->tail_ = this->used_ = 0;
+  this->record_count_ = this->dropped_count_ = 0;
+  this->active_ = true;
+  return true;
+}
+
+void TrafficCapture::record(capture_type type, uint32_t time, const uint8_t *data, uint16_t length,
+    uint16_t queue_depth, uint16_t wait) {
+  if (!this->active_) return;
+  length = std::min(length, CAPTURE_MAX_DATA);
+  capture_record r{time, type, queue_depth, wait, length};
+  size_t record_size = sizeof(r) + length;
+  if (record_size > this->size_) {
+    this->dropped_count_++;
+    return;
+  }
+  while (this->size_ - this->used_ < record_size) {
+    this->drop_oldest_();
+  }
+  this->write_(&r, sizeof(r));
+  this->write_(data, length);
+  this->used_ += record_size;
+  this->record_count_++;
+}
+
+void TrafficCapture::for_each(
+    const std::function<void(const capture_record &, const uint8_t *)> &callback) const {
+  size_t pos = this->tail_;
+  for (uint32_t i = 0; i < this->record_count_; i++) {
+    capture_record r;
+    this->read_(pos, &r, sizeof(r));
+    pos = (pos + sizeof(r)) % this->size_;
+    this->read_(pos, this->scratch_, r.length);
+    pos = (pos + r.length) % this->size_;
+    callback(r, this->scratch_);
+  }
+}
+
+void TrafficCapture::write_(const void *data, size_t length) {
+  auto *src = static_cast<const uint8_t *>(data);
+  size_t first = std::min(length, this->size_ - this->head_);
+  std::memcpy(this->buffer_ + this->head_, src, first);
+  std::memcpy(this->buffer_, src + first, length - first);
+  this->head_ = (this->head_ + length) % this->size_;
+}
+
+void TrafficCapture::read_(size_t pos, void *data, size_t length) const {
+  auto *dst = static_cast<uint8_t *>(data);
+  size_t first = std::min(length, this->size_ - pos);
+  std::memcpy(dst, this->buffer_ + pos, first);
+  std::memcpy(dst + first, this->buffer_, length - first);
+}
+
+void TrafficCapture::drop_oldest_() {
+  capture_record r;
+  this->read_(this->tail_, &r, sizeof(r));
+  size_t record_size = sizeof(r) + r.length;
+  this->tail_ = (this->tail_ + record_size) % this->size_;
+  this->used_ -= record_size;
+  this->record_count_--;
+  this->dropped_count_++;
+}
+
+}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// What a captured record holds
+enum class capture_type : char {
+  message = 'M',      // message received from the TFT (payload only)
+  startup = 'S',      // Nextion startup sequence
+  ready = 'R',        // Nextion ready sequence
+  crc_mismatch = 'C', // frame received with an invalid checksum
+  invalid = 'I',      // bytes that couldn't be decoded
+  sent = 'T'          // command sent to the TFT (payload only)
+};
+
+struct capture_record {
+  uint32_t time;        // millis() when the frame was received or sent
+  capture_type type;
+  uint16_t queue_depth; // commands still queued after a send
+  uint16_t wait;        // ms a sent command spent in the queue
+  uint16_t length;
+};
+
+// Records the frames exchanged with the TFT into a fixed size buffer
+// (in PSRAM when available), the oldest records are overwritten once it is full.
+//
+// The records are written to the log by NSPanelLovelace::dump_traffic_capture(), one line per record:
+//   cap,{time},{type},{queue_depth},{wait},{hex}
+// followed by 'cap+,{hex}' lines when the data doesn't fit into a single line.
+class TrafficCapture {
+public:
+  ~TrafficCapture();
+
+  void set_size(size_t size) { this->size_ = size; }
+  size_t get_size() const { return this->size_; }
+
+  // Clears previous records and starts recording
+  bool start();
+  void stop() { this->active_ = false; }
+  bool is_active() const { return this->active_; }
+
+  void record(capture_type type, uint32_t time, const uint8_t *data, uint16_t length,
+    uint16_t queue_depth = 0, uint16_t wait = 0);
+  // Calls 'callback' for each record, oldest first
+  void for_each(const std::function<void(const capture_record &, const uint8_t *)> &callback) const;
+
+  // Records currently held
+  uint32_t get_record_count() const { return this->record_count_; }
+  // Records that were overwritten (or didn't fit)
+  uint32_t get_dropped_count() const { return this->dropped_count_; }
+
+protected:
+  void write_(const void *data, size_t length);
+  void read_(size_t pos, void *data, size_t length) const;
+  void drop_oldest_();
+
+  uint8_t *buffer_ = nullptr;
+  uint8_t *scratch_ = nullptr;
+  size_t size_ = 0;
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  size_t used_ = 0;
+  bool active_ = false;
+  uint32_t record_count_ = 0;
+  uint32_t dropped_count_ = 0;
+};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
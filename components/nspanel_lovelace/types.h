@@ -656,13 +656,6 @@ inline const char *to_string(ha_attr_type attr) {
   return ha_attr_names[(uint8_t)attr];
 }
 
-inline ha_attr_type to_ha_attr(const std::string &attr) {
-  for (uint8_t i = 0; i < (sizeof(ha_attr_names) / sizeof(*ha_attr_names)); i++) {
-    if (attr == ha_attr_names[i]) return static_cast<ha_attr_type>(i);
-  }
-  return ha_attr_type::unknown;
-}
-
 struct ha_attr_color_mode {
   static constexpr const char* onoff = "onoff";
   static constexpr const char* color_temp = "color_temp";
@@ -741,25 +734,42 @@ inline bool try_get_value(
 template<typename Value, size_t Size>
 inline const Value &get_value_or_default(
     const FrozenCharMap<Value, Size> &map,
-    const std::string &key,
+    const char *key,
     const Value &default_value,
     const char *fallback_key = nullptr) {
   // todo: fix this bad implementation
   //       use pointers and unwrap Value?
   static Value ret{};
-  if (try_get_value(map, ret, key.c_str(), fallback_key))
+  if (try_get_value(map, ret, key, fallback_key))
     return ret;
   return default_value;
 }
 
+template<typename Value, size_t Size>
+inline const Value &get_value_or_default(
+    const FrozenCharMap<Value, Size> &map,
+    const std::string &key,
+    const Value &default_value,
+    const char *fallback_key = nullptr) {
+  return get_value_or_default(map, key.c_str(), default_value, fallback_key);
+}
+
 template<size_t Size>
 inline const icon_char_t *get_icon(
     const FrozenCharMap<const icon_char_t *, Size> &map,
-    const std::string &key,
+    const char *key,
     const char *fallback_key = nullptr) {
   return get_value_or_default(map, key, icon_t::alert_circle_outline, fallback_key);
 }
 
+template<size_t Size>
+inline const icon_char_t *get_icon(
+    const FrozenCharMap<const icon_char_t *, Size> &map,
+    const std::string &key,
+    const char *fallback_key = nullptr) {
+  return get_icon(map, key.c_str(), fallback_key);
+}
+
 // simple_type_mapping
 static constexpr FrozenCharMap<const icon_char_t *, 22> ENTITY_ICON_MAP {{
   std::pair<const char*, const icon_char_t*>{entity_type::button, icon_t::gesture_tap_button},
@@ -0,0 +1,132 @@
+// Measures the time to find the handler of each button type: the binary search
+// over NSPanelLovelace::BUTTON_HANDLERS (find_by_type) against the previous chain
+// of string comparisons in NSPanelLovelace::process_button_press_.
+//
+// Both look up the component's own handler functions, so a type that the legacy
+// chain and the table dispatch differently fails the run.
+//
+// usage: bench_button_dispatch [--iterations N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "helpers.h"
+#include "nspanel_lovelace.h"
+#include "types.h"
+
+using namespace esphome::nspanel_lovelace;
+
+namespace {
+
+// Gives the benchmark access to the protected handler table and functions
+struct Dispatch : NSPanelLovelace {
+  static const button_handler *begin() { return BUTTON_HANDLERS; }
+  static const button_handler *end() { return BUTTON_HANDLERS + BUTTON_HANDLER_COUNT; }
+
+  static button_handler_t table(const std::string &button_type) {
+    auto entry = find_by_type(BUTTON_HANDLERS, BUTTON_HANDLER_COUNT, button_type.c_str());
+    return entry == nullptr ? nullptr : entry->handler;
+  }
+
+  static button_handler_t legacy(const std::string &button_type) {
+    if (button_type == button_type::sleepReached) return &Dispatch::button_sleep_reached_;
+    if (button_type == button_type::bExit) return &Dispatch::button_exit_;
+    if (button_type == button_type::onOff) return &Dispatch::button_on_off_;
+    else if (button_type == button_type::numberSet) return &Dispatch::button_number_set_;
+    else if (button_type == button_type::up) return &Dispatch::button_action_;
+    else if (button_type == button_type::stop) return &Dispatch::button_action_;
+    else if (button_type == button_type::down) return &Dispatch::button_action_;
+    else if (button_type == button_type::positionSlider) return &Dispatch::button_position_slider_;
+    else if (button_type == button_type::tiltOpen) return &Dispatch::button_action_;
+    else if (button_type == button_type::tiltStop) return &Dispatch::button_action_;
+    else if (button_type == button_type::tiltClose) return &Dispatch::button_action_;
+    else if (button_type == button_type::tiltSlider) return &Dispatch::button_tilt_slider_;
+    else if (button_type == button_type::button) return &Dispatch::button_button_;
+    else if (button_type == button_type::mediaNext) return &Dispatch::button_action_;
+    else if (button_type == button_type::mediaBack) return &Dispatch::button_action_;
+    else if (button_type == button_type::mediaPause) return &Dispatch::button_action_;
+    else if (button_type == button_type::mediaOnOff) return &Dispatch::button_media_on_off_;
+    else if (button_type == button_type::mediaShuffle) return &Dispatch::button_media_shuffle_;
+    else if (button_type == button_type::volumeSlider) return &Dispatch::button_volume_slider_;
+    else if (button_type == button_type::speakerSel) return &Dispatch::button_speaker_sel_;
+    else if (button_type == button_type::modeMediaPlayer) return &Dispatch::button_media_source_;
+    else if (button_type == button_type::brightnessSlider) return &Dispatch::button_brightness_slider_;
+    else if (button_type == button_type::colorTempSlider) return &Dispatch::button_color_temp_slider_;
+    else if (button_type == button_type::colorWheel) return &Dispatch::button_color_wheel_;
+    else if (button_type == button_type::tempUpd) return &Dispatch::button_temp_upd_;
+    else if (button_type == button_type::tempUpdHighLow) return &Dispatch::button_temp_upd_high_low_;
+    else if (button_type == button_type::hvacAction) return &Dispatch::button_hvac_action_;
+    else if (button_type == button_type::modePresetModes) return &Dispatch::button_climate_mode_;
+    else if (button_type == button_type::modeSwingModes) return &Dispatch::button_climate_mode_;
+    else if (button_type == button_type::modeFanModes) return &Dispatch::button_climate_mode_;
+    else if (
+        button_type == button_type::armHome ||
+        button_type == button_type::armAway ||
+        button_type == button_type::armNight ||
+        button_type == button_type::armVacation ||
+        button_type == button_type::disarm) return &Dispatch::button_alarm_;
+    else if (button_type == button_type::opnSensorNotify) return &Dispatch::button_open_sensors_;
+    else if (button_type == button_type::cardUnlockUnlock) return &Dispatch::button_card_unlock_;
+    else if (
+        button_type == button_type::modeInputSelect ||
+        button_type == button_type::modeSelect) return &Dispatch::button_select_option_;
+    else if (button_type == button_type::modeLight) return &Dispatch::button_light_effect_;
+    else if (button_type.compare(0, std::strlen(entity_type::timer), entity_type::timer) == 0)
+      return &Dispatch::button_timer_;
+    return nullptr;
+  }
+};
+
+template<typename F>
+double ns_per_dispatch(const std::string &type, int iterations, F &&dispatch, uint32_t &sink) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    sink += dispatch(type) != nullptr;
+    // keep the compiler from hoisting the lookup out of the loop
+    asm volatile("" : : "r"(&type) : "memory");
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int iterations = 200000;
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--iterations") && i + 1 < argc) {
+      iterations = std::max(1, std::atoi(argv[++i]));
+    } else {
+      std::fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<std::string> types;
+  for (auto it = Dispatch::begin(); it != Dispatch::end(); ++it) types.emplace_back(it->type);
+  types.emplace_back("unknownType");
+
+  uint32_t sink = 0;
+  double legacy_total = 0, table_total = 0;
+  bool ok = true;
+  std::printf("iterations: %d\n", iterations);
+  std::printf("%-18s %12s %12s\n", "button type", "legacy ns", "table ns");
+  for (auto &type : types) {
+    if (Dispatch::legacy(type) != Dispatch::table(type)) {
+      std::fprintf(stderr, "'%s' dispatched to different handlers\n", type.c_str());
+      ok = false;
+    }
+    auto legacy = ns_per_dispatch(type, iterations, Dispatch::legacy, sink);
+    auto table = ns_per_dispatch(type, iterations, Dispatch::table, sink);
+    legacy_total += legacy;
+    table_total += table;
+    std::printf("%-18s %12.1f %12.1f\n", type.c_str(), legacy, table);
+  }
+  std::printf("%-18s %12.1f %12.1f\n", "mean", legacy_total / types.size(), table_total / types.size());
+  std::printf("(checksum %u)\n", sink);
+  return ok ? 0 : 1;
+}
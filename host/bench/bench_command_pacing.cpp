@@ -0,0 +1,168 @@
+// Compares how long page switches and popup opens take to reach the TFT with
+// the fixed and adaptive command pacing policies.
+//
+// CommandQueue and CommandPacer are driven the way NSPanelLovelace::loop() drives
+// them (at most one frame per loop() once the pacer is ready) on a simulated clock.
+// The TFT is modelled as a serial input buffer that is drained one frame at a
+// time. A frame that doesn't fit into the buffer is lost, the TFT then repeats
+// the event after TFT_REPEAT_US, which is reported to the pacer as an overload
+// and causes the response to be sent again.
+//
+// usage: bench_command_pacing [--loop-interval MS] [--tft-frame-us US] [--tft-byte-us US] [--tft-buffer BYTES]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "command_pacer.h"
+#include "command_queue.h"
+
+using namespace esphome::nspanel_lovelace;
+
+namespace {
+
+struct tft_model {
+  uint32_t frame_us = 3000;  // parsing and switching page/redrawing per frame
+  uint32_t byte_us = 20;     // rendering cost per payload byte
+  uint32_t buffer = 1024;    // serial input buffer of the TFT
+};
+
+// How long the TFT takes to repeat an event it got no response for
+constexpr uint64_t TFT_REPEAT_US = 250000;
+
+struct scenario {
+  const char *name;
+  std::vector<std::pair<const char *, size_t>> commands; // instruction, payload length
+};
+
+struct outcome {
+  double latency_ms;
+  uint32_t lost_frames;
+};
+
+std::string make_command(const char *instruction, size_t length) {
+  std::string command(instruction);
+  command.append(1, SEPARATOR);
+  while (command.length() < length) command.append(1, 'a' + command.length() % 26);
+  return command;
+}
+
+outcome run(const scenario &sc, command_pacing_t policy, uint32_t baud_rate,
+    uint32_t loop_interval_ms, const tft_model &tft) {
+  CommandQueue queue;
+  CommandPacer pacer;
+  pacer.set_policy(policy);
+
+  uint64_t now = 1000000; // us, the pacer must not think a frame was just sent
+  uint64_t wire_free = now, tft_free = now;
+  // payload lengths received by the TFT but not processed yet, with their arrival time
+  std::deque<std::pair<uint64_t, size_t>> tft_buffer;
+  std::vector<std::string> lost;
+  uint64_t repeat_at = 0, done_at = now;
+  uint32_t lost_frames = 0;
+  size_t remaining = sc.commands.size();
+
+  for (auto &c : sc.commands)
+    queue.push(make_command(c.first, c.second), command_priority::interactive, now / 1000);
+
+  auto drain_tft = [&](uint64_t until) {
+    while (!tft_buffer.empty()) {
+      auto start = std::max(tft_free, tft_buffer.front().first);
+      auto end = start + tft.frame_us + tft_buffer.front().second * tft.byte_us;
+      if (end > until) break;
+      tft_free = end;
+      tft_buffer.pop_front();
+      done_at = end;
+    }
+  };
+
+  while (remaining > 0 && now < 60000000ULL) {
+    drain_tft(now);
+    if (repeat_at != 0 && now >= repeat_at) {
+      // the repeated event makes the component render the lost frames again
+      repeat_at = 0;
+      pacer.on_overload(now / 1000);
+      for (auto &command : lost) queue.push(command, command_priority::interactive, now / 1000);
+      lost.clear();
+    }
+
+    const uint8_t *frame;
+    size_t length;
+    if (pacer.is_ready(now / 1000) && queue.pop(frame, length, now / 1000)) {
+      std::string command(reinterpret_cast<const char *>(frame) + 4, length - 6);
+      auto wire_start = std::max(now, wire_free);
+      wire_free = wire_start + (uint64_t(length) * 10 * 1000000) / baud_rate;
+      drain_tft(wire_free);
+      size_t buffered = 0;
+      for (auto &f : tft_buffer) buffered += f.second + 6;
+      // a frame longer than the buffer is only read in full when nothing is pending
+      if (buffered > 0 && buffered + length > tft.buffer) {
+        lost_frames++;
+        lost.push_back(command);
+        if (repeat_at == 0) repeat_at = wire_free + TFT_REPEAT_US;
+      } else {
+        tft_buffer.emplace_back(wire_free, length - 6);
+        remaining--;
+      }
+      pacer.on_sent(now / 1000, length, baud_rate);
+    }
+    now += uint64_t(loop_interval_ms) * 1000;
+  }
+  drain_tft(UINT64_MAX);
+  return {(done_at - 1000000) / 1000.0, lost_frames};
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  uint32_t loop_interval = 16;
+  tft_model tft;
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--loop-interval") && i + 1 < argc) {
+      loop_interval = std::max(1, std::atoi(argv[++i]));
+    } else if (!std::strcmp(argv[i], "--tft-frame-us") && i + 1 < argc) {
+      tft.frame_us = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--tft-byte-us") && i + 1 < argc) {
+      tft.byte_us = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--tft-buffer") && i + 1 < argc) {
+      tft.buffer = std::atoi(argv[++i]);
+    } else {
+      std::fprintf(stderr, "usage: %s [--loop-interval MS] [--tft-frame-us US] "
+        "[--tft-byte-us US] [--tft-buffer BYTES]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  const scenario scenarios[] = {
+    {"grid page", {{"pageType", 20}, {"timeout", 10}, {"entityUpd", 420}}},
+    {"entities page", {{"pageType", 24}, {"timeout", 10}, {"entityUpd", 260}}},
+    {"popup", {{"pageType", 24}, {"entityUpdateDetail", 150}}},
+    {"screensaver", {{"pageType", 20}, {"timeout", 10}, {"weatherUpdate", 300},
+      {"time", 10}, {"date", 30}, {"statusUpdate", 40}}},
+  };
+  const uint32_t baud_rates[] = {115200, 921600};
+
+  std::printf("loop interval: %ums, tft: %uus/frame + %uus/byte, %u byte buffer\n",
+    loop_interval, tft.frame_us, tft.byte_us, tft.buffer);
+  std::printf("%-14s %8s %12s %6s %12s %6s\n",
+    "scenario", "baud", "fixed ms", "lost", "adaptive ms", "lost");
+  bool ok = true;
+  for (auto &sc : scenarios) {
+    for (auto baud_rate : baud_rates) {
+      auto fixed = run(sc, command_pacing_t::fixed, baud_rate, loop_interval, tft);
+      auto adaptive = run(sc, command_pacing_t::adaptive, baud_rate, loop_interval, tft);
+      std::printf("%-14s %8u %12.1f %6u %12.1f %6u\n", sc.name, baud_rate,
+        fixed.latency_ms, fixed.lost_frames, adaptive.latency_ms, adaptive.lost_frames);
+      ok = ok && adaptive.latency_ms <= fixed.latency_ms;
+    }
+  }
+  if (!ok) {
+    std::fprintf(stderr, "adaptive pacing was slower than fixed pacing\n");
+    return 1;
+  }
+  return 0;
+}
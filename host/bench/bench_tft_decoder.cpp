@@ -0,0 +1,216 @@
+// Measures the bytes/sec decoded by TFTDecoder against the previous per-byte
+// decoder (a port of NSPanelLovelace::process_data_ before the ring buffer).
+//
+// usage: bench_tft_decoder [--iterations N] [--chunk N] [--input rx.bin]
+//   --input   raw bytes received from the TFT, instead of the synthetic bursts
+//   --chunk   max bytes read per loop() (the UART FIFO holds 128), default 120
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "esphome/core/helpers.h"
+#include "tft_decoder.h"
+
+using esphome::nspanel_lovelace::TFTDecoder;
+using esphome::nspanel_lovelace::tft_frame_type;
+
+namespace {
+
+struct result {
+  size_t messages = 0;
+  size_t payload_bytes = 0;
+  size_t rejected = 0;
+};
+
+void append_frame(std::vector<uint8_t> &stream, const std::string &payload, bool corrupt = false) {
+  auto start = stream.size();
+  stream.push_back(0x55);
+  stream.push_back(0xBB);
+  stream.push_back(payload.length() & 0xFF);
+  stream.push_back((payload.length() >> 8) & 0xFF);
+  stream.insert(stream.end(), payload.begin(), payload.end());
+  auto crc = esphome::crc16(&stream[start], payload.length() + 4);
+  if (corrupt) crc ^= 0x5A5A;
+  stream.push_back(crc & 0xFF);
+  stream.push_back((crc >> 8) & 0xFF);
+}
+
+// Slider drags and button presses, with the odd startup/ready sequence,
+// corrupt frame and line noise in between
+std::vector<uint8_t> make_bursts(size_t frames) {
+  static const char *const entities[] = {
+    "light.living_room", "light.kitchen_ceiling", "cover.bedroom_blinds", "media_player.lounge"};
+  std::mt19937 rng(1234);
+  std::vector<uint8_t> stream;
+  for (size_t i = 0; i < frames; i++) {
+    auto kind = rng() % 100;
+    auto entity = entities[rng() % 4];
+    if (kind < 60) {
+      append_frame(stream, std::string("event,buttonPress2,") + entity +
+        ",brightnessSlider," + std::to_string(rng() % 256));
+    } else if (kind < 85) {
+      append_frame(stream, std::string("event,buttonPress2,") + entity + ",OnOff," + std::to_string(rng() % 2));
+    } else if (kind < 95) {
+      append_frame(stream, std::string("event,pageOpenDetail,popupLight,") + entity);
+    } else if (kind < 97) {
+      static const uint8_t startup[] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF};
+      static const uint8_t ready[] = {0x88, 0xFF, 0xFF, 0xFF};
+      stream.insert(stream.end(), std::begin(startup), std::end(startup));
+      stream.insert(stream.end(), std::begin(ready), std::end(ready));
+      append_frame(stream, "event,startup,53,eu");
+    } else if (kind < 99) {
+      append_frame(stream, std::string("event,buttonPress2,") + entity + ",up", true);
+    } else {
+      for (int n = 0; n < 5; n++) stream.push_back(rng() & 0xFF);
+    }
+  }
+  return stream;
+}
+
+// The decoder before the ring buffer: one byte at a time into a vector,
+// re-deriving the frame state from the buffered bytes for every byte
+class LegacyDecoder {
+public:
+  explicit LegacyDecoder(result &res) : res_(res) {}
+
+  void feed(const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      this->buffer_.push_back(data[i]);
+      if (!this->process_data_()) {
+        this->res_.rejected++;
+        this->buffer_.clear();
+      }
+    }
+  }
+
+protected:
+  bool process_data_() {
+    uint32_t at = this->buffer_.size() - 1;
+    auto *data = &this->buffer_[0];
+    uint8_t new_byte = data[at];
+
+    if (data[0] == 0x0) {
+      if (at > 5) return false;
+      static constexpr uint8_t seq[] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF};
+      bool match = data[at] == seq[at];
+      if (at == 5 && match) this->buffer_.clear();
+      return match;
+    }
+    if (data[0] == 0x88) {
+      if (at > 3) return false;
+      static constexpr uint8_t seq[] = {0x88, 0xFF, 0xFF, 0xFF};
+      bool match = data[at] == seq[at];
+      if (at == 3 && match) this->buffer_.clear();
+      return match;
+    }
+
+    if (at == 0) return new_byte == 0x55;
+    if (at == 1) return new_byte == 0xBB;
+    if (at == 2 || at == 3) return true;
+    uint16_t length = esphome::encode_uint16(data[3], data[2]);
+    if (at - 4 < length) return true;
+    if (at == 4u + length) return true;
+
+    uint16_t crc16 = esphome::encode_uint16(data[4 + length + 1], data[4 + length]);
+    if (crc16 != esphome::crc16(data, 4 + length)) return false;
+
+    std::string message(data + 4, data + 4 + length);
+    this->res_.messages++;
+    this->res_.payload_bytes += message.length();
+    this->buffer_.clear();
+    return true;
+  }
+
+  std::vector<uint8_t> buffer_;
+  result &res_;
+};
+
+void run_decoder(TFTDecoder &decoder, const uint8_t *data, size_t length, result &res) {
+  while (length > 0) {
+    size_t space;
+    uint8_t *ptr = decoder.write_ptr(space);
+    if (space > length) space = length;
+    std::memcpy(ptr, data, space);
+    decoder.commit(space);
+    data += space;
+    length -= space;
+
+    tft_frame_type type;
+    while ((type = decoder.decode()) != tft_frame_type::none) {
+      if (type == tft_frame_type::message) {
+        res.messages++;
+        res.payload_bytes += decoder.length();
+      } else if (type == tft_frame_type::crc_mismatch || type == tft_frame_type::invalid) {
+        res.rejected++;
+      }
+    }
+  }
+}
+
+template<typename F>
+double measure(const std::vector<uint8_t> &stream, size_t chunk, int iterations, F &&feed) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+      feed(stream.data() + pos, std::min(chunk, stream.size() - pos));
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(stream.size()) * iterations / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int iterations = 200;
+  size_t chunk = 120;
+  std::vector<uint8_t> stream;
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--iterations") && i + 1 < argc) {
+      iterations = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--chunk") && i + 1 < argc) {
+      chunk = std::max(1, std::atoi(argv[++i]));
+    } else if (!std::strcmp(argv[i], "--input") && i + 1 < argc) {
+      std::ifstream file(argv[++i], std::ios::binary);
+      if (!file) {
+        std::fprintf(stderr, "can't read %s\n", argv[i]);
+        return 1;
+      }
+      stream.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+      std::fprintf(stderr, "usage: %s [--iterations N] [--chunk N] [--input rx.bin]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (stream.empty()) stream = make_bursts(5000);
+
+  result legacy_res, ring_res;
+  LegacyDecoder legacy(legacy_res);
+  double legacy_rate = measure(stream, chunk, iterations,
+    [&](const uint8_t *data, size_t length) { legacy.feed(data, length); });
+  TFTDecoder decoder;
+  double ring_rate = measure(stream, chunk, iterations,
+    [&](const uint8_t *data, size_t length) { run_decoder(decoder, data, length, ring_res); });
+
+  std::printf("stream: %zu bytes, chunk: %zu, iterations: %d\n", stream.size(), chunk, iterations);
+  std::printf("%-8s %14s %10s %10s\n", "decoder", "bytes/sec", "messages", "rejected");
+  std::printf("%-8s %14.0f %10zu %10zu\n", "legacy", legacy_rate,
+    legacy_res.messages / iterations, legacy_res.rejected / iterations);
+  std::printf("%-8s %14.0f %10zu %10zu\n", "ring", ring_rate,
+    ring_res.messages / iterations, ring_res.rejected / iterations);
+  std::printf("speedup: %.1fx\n", ring_rate / legacy_rate);
+
+  // the ring decoder resynchronises inside corrupt frames, so it must never lose a valid one
+  if (ring_res.messages < legacy_res.messages) {
+    std::fprintf(stderr, "ring decoder lost messages\n");
+    return 1;
+  }
+  return 0;
+}
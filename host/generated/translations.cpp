@@ -0,0 +1,16 @@
+#include "translations.h"
+
+namespace esphome {
+namespace nspanel_lovelace {
+
+// What the esphome build generates from the selected language
+// (the host build only translates what the replay and tests display)
+constexpr FrozenCharMap<const char *, TRANSLATION_MAP_SIZE> TRANSLATION_MAP {{
+  {translation_item::none, "None"},
+  {translation_item::unknown, "Unknown"},
+  {translation_item::on, "On"},
+  {translation_item::off, "Off"},
+}};
+
+} // namespace nspanel_lovelace
+} // namespace esphome
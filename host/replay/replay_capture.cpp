@@ -0,0 +1,473 @@
+// Replays a traffic capture (NSPanelLovelace::dump_traffic_capture()) into the
+// component built for the host and reports how it kept up with the TFT.
+//
+// The frames received from the TFT are written to a mock UART at their recorded
+// times (relative to the first record), loop() runs every --loop-interval ms on a
+// simulated clock and the frames sent by the component are collected from the UART.
+// Home Assistant is simulated too: service calls change the state of the entity
+// after --ha-delay ms. The frames the panel sent during the capture ('T') are only
+// used to compare the capture with the replay.
+//
+// The panel is configured by configure_panel() below, events for uuids that
+// aren't part of it are ignored, like on a panel with a different configuration.
+//
+// usage: replay_capture [--speed X] [--loop-interval MS] [--rx-buffer BYTES] [--bucket MS]
+//                       [--ha-delay MS] [--log-level N] [--dump FILE] capture.log
+//   --speed   1 replays in real time, 10 ten times faster, 0 (default) as fast as possible
+//   --dump    writes the capture recorded during the replay, in the same format
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esphome/core/host.h"
+#include "esphome/components/api/custom_api_device.h"
+#include "esphome/components/time/real_time_clock.h"
+#include "esphome/components/uart/mock_uart.h"
+
+#include "card_items.h"
+#include "cards.h"
+#include "nspanel_lovelace.h"
+#include "page_items.h"
+#include "pages.h"
+
+using namespace esphome;
+using namespace esphome::nspanel_lovelace;
+
+namespace {
+
+// Gives the replay access to the state the panel doesn't publish
+class ReplayPanel : public NSPanelLovelace {
+public:
+  size_t get_queue_depth() const { return this->command_queue_.size(); }
+  uint32_t get_queue_overflows() const { return this->command_queue_.get_overflow_count(); }
+  const TrafficCapture &get_traffic_capture() const { return this->traffic_capture_; }
+};
+
+// What the esphome build generates for a screensaver and two cards
+void configure_panel(ReplayPanel &panel, time::RealTimeClock &rtc) {
+  panel.set_time_id(&rtc);
+  panel.set_language("en");
+  panel.set_command_pacing(command_pacing_t::adaptive);
+  panel.set_render_frame_rate(10);
+  {
+    panel.set_date_format("%A, %d. %B %Y");
+    panel.set_time_format("%H:%M");
+    panel.insert_page<Screensaver>(0, "1");
+  }
+  {
+    auto card = panel.create_page<GridCard>("2", "Lights", 10);
+    auto navleft = std::unique_ptr<NavigationItem>(new NavigationItem("3", "9"));
+    card->set_nav_left(navleft);
+    auto navright = std::unique_ptr<NavigationItem>(new NavigationItem("4", "9"));
+    card->set_nav_right(navright);
+    const char *entity_ids[] = {"light.living_room", "light.kitchen", "switch.coffee_machine", "light.bedroom"};
+    for (size_t i = 0; i < 4; i++) {
+      auto entity = panel.create_entity(entity_ids[i]);
+      card->add_item(std::make_shared<GridCardEntityItem>(std::to_string(5 + i), entity));
+    }
+  }
+  {
+    auto card = panel.create_page<EntitiesCard>("9", "Home", 10);
+    auto navleft = std::unique_ptr<NavigationItem>(new NavigationItem("10", "2"));
+    card->set_nav_left(navleft);
+    auto navright = std::unique_ptr<NavigationItem>(new NavigationItem("11", "2"));
+    card->set_nav_right(navright);
+    const char *entity_ids[] = {"cover.living_room_blinds", "sensor.outside_temperature", "switch.heater", "light.hallway"};
+    for (size_t i = 0; i < 4; i++) {
+      auto entity = panel.create_entity(entity_ids[i]);
+      card->add_item(std::make_shared<EntitiesCardEntityItem>(std::to_string(12 + i), entity));
+    }
+  }
+}
+
+std::string initial_state(const std::string &entity_id) {
+  if (entity_id.compare(0, 6, "cover.") == 0) return "open";
+  if (entity_id.compare(0, 7, "sensor.") == 0) return "12.5";
+  return "off";
+}
+
+// The state Home Assistant reports after the service call
+std::string state_after_call(const std::string &service, const std::string &state) {
+  auto action = service.substr(service.find('.') + 1);
+  if (action == "turn_on" || action == "open_cover") return action == "turn_on" ? "on" : "open";
+  if (action == "turn_off" || action == "close_cover") return action == "turn_off" ? "off" : "closed";
+  if (action == "toggle") return state == "on" ? "off" : "on";
+  return state;
+}
+
+struct capture_entry {
+  uint32_t time;
+  char type;
+  uint16_t queue_depth;
+  uint16_t wait;
+  std::vector<uint8_t> data;
+};
+
+int hex_digit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+void append_hex(const char *hex, std::vector<uint8_t> &data) {
+  int hi, lo;
+  while ((hi = hex_digit(hex[0])) >= 0 && (lo = hex_digit(hex[1])) >= 0) {
+    data.push_back(hi << 4 | lo);
+    hex += 2;
+  }
+}
+
+// Log lines can have a prefix (time, level, tag) and colour codes, the records are found anywhere in a line
+bool read_capture(const char *path, std::vector<capture_entry> &entries, uint32_t &dropped) {
+  std::ifstream file(path);
+  if (!file) return false;
+  std::string line;
+  while (std::getline(file, line)) {
+    const char *pos;
+    unsigned records, dropped_records;
+    if ((pos = std::strstr(line.c_str(), "cap+,")) != nullptr) {
+      if (!entries.empty()) append_hex(pos + 5, entries.back().data);
+    } else if ((pos = std::strstr(line.c_str(), "cap,")) != nullptr) {
+      capture_entry entry{};
+      unsigned time, queue_depth, wait;
+      int hex_at = 0;
+      if (std::sscanf(pos, "cap,%u,%c,%u,%u,%n", &time, &entry.type, &queue_depth, &wait, &hex_at) < 4 ||
+          hex_at == 0) {
+        std::fprintf(stderr, "skipped: %s\n", line.c_str());
+        continue;
+      }
+      entry.time = time;
+      entry.queue_depth = queue_depth;
+      entry.wait = wait;
+      append_hex(pos + hex_at, entry.data);
+      entries.push_back(std::move(entry));
+    } else if ((pos = std::strstr(line.c_str(), "Traffic capture: ")) != nullptr &&
+        std::sscanf(pos, "Traffic capture: %u records, %u dropped", &records, &dropped_records) == 2) {
+      dropped += dropped_records;
+    }
+  }
+  return true;
+}
+
+bool is_event(const capture_entry &entry) {
+  return entry.type == 'M' && entry.data.size() > 6 && std::memcmp(entry.data.data(), "event,", 6) == 0;
+}
+
+void append_frame(std::vector<uint8_t> &stream, const std::vector<uint8_t> &payload) {
+  auto start = stream.size();
+  stream.push_back(0x55);
+  stream.push_back(0xBB);
+  stream.push_back(payload.size() & 0xFF);
+  stream.push_back((payload.size() >> 8) & 0xFF);
+  stream.insert(stream.end(), payload.begin(), payload.end());
+  auto crc = crc16(&stream[start], payload.size() + 4);
+  stream.push_back(crc & 0xFF);
+  stream.push_back((crc >> 8) & 0xFF);
+}
+
+uint32_t percentile(std::vector<uint32_t> values, uint8_t percentile) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  size_t index = (values.size() * percentile + 99) / 100;
+  return values[std::max<size_t>(index, 1) - 1];
+}
+
+double mean(const std::vector<uint32_t> &values) {
+  if (values.empty()) return 0;
+  double sum = 0;
+  for (auto value : values) sum += value;
+  return sum / values.size();
+}
+
+void print_stats(const char *name, const std::vector<uint32_t> &capture, const std::vector<uint32_t> &replay) {
+  std::printf("  %-22s %6zu %7.1f %5u %5u %5u   %6zu %7.1f %5u %5u %5u\n", name,
+    capture.size(), mean(capture), percentile(capture, 50), percentile(capture, 95), percentile(capture, 100),
+    replay.size(), mean(replay), percentile(replay, 50), percentile(replay, 95), percentile(replay, 100));
+}
+
+// Time (ms) from each event to the next frame sent, events followed by another event are unanswered
+std::vector<uint32_t> response_latencies(const std::vector<capture_entry> &entries, uint32_t &unanswered) {
+  std::vector<uint32_t> latencies;
+  const capture_entry *pending = nullptr;
+  for (auto &entry : entries) {
+    if (is_event(entry)) {
+      if (pending != nullptr) unanswered++;
+      pending = &entry;
+    } else if (entry.type == 'T' && pending != nullptr) {
+      latencies.push_back(entry.time - pending->time);
+      pending = nullptr;
+    }
+  }
+  if (pending != nullptr) unanswered++;
+  return latencies;
+}
+
+struct queue_bucket {
+  uint32_t capture_max = 0;
+  uint32_t replay_max = 0;
+  uint64_t replay_sum = 0;
+  uint32_t replay_samples = 0;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  double speed = 0;
+  uint32_t loop_interval = 16, bucket_ms = 1000, ha_delay = 80;
+  size_t rx_buffer = 256;
+  const char *capture_path = nullptr, *dump_path = nullptr;
+  host::log_level = ESPHOME_LOG_LEVEL_ERROR;
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--speed") && i + 1 < argc) {
+      speed = std::max(0.0, std::atof(argv[++i]));
+    } else if (!std::strcmp(argv[i], "--loop-interval") && i + 1 < argc) {
+      loop_interval = std::max(1, std::atoi(argv[++i]));
+    } else if (!std::strcmp(argv[i], "--rx-buffer") && i + 1 < argc) {
+      rx_buffer = std::max(1, std::atoi(argv[++i]));
+    } else if (!std::strcmp(argv[i], "--bucket") && i + 1 < argc) {
+      bucket_ms = std::max(1, std::atoi(argv[++i]));
+    } else if (!std::strcmp(argv[i], "--ha-delay") && i + 1 < argc) {
+      ha_delay = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--log-level") && i + 1 < argc) {
+      host::log_level = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--dump") && i + 1 < argc) {
+      dump_path = argv[++i];
+    } else if (argv[i][0] != '-' && capture_path == nullptr) {
+      capture_path = argv[i];
+    } else {
+      capture_path = nullptr;
+      break;
+    }
+  }
+  if (capture_path == nullptr) {
+    std::fprintf(stderr, "usage: %s [--speed X] [--loop-interval MS] [--rx-buffer BYTES] [--bucket MS] "
+      "[--ha-delay MS] [--log-level N] [--dump FILE] capture.log\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<capture_entry> entries;
+  uint32_t capture_dropped = 0;
+  if (!read_capture(capture_path, entries, capture_dropped)) {
+    std::fprintf(stderr, "can't read %s\n", capture_path);
+    return 1;
+  }
+  if (entries.empty()) {
+    std::fprintf(stderr, "no capture records in %s\n", capture_path);
+    return 1;
+  }
+
+  // the records are replayed once the panel has been set up
+  constexpr uint32_t START_MS = 2000;
+  constexpr uint32_t DRAIN_MS = 2000;
+  const uint32_t offset = START_MS - entries.front().time;
+  host::set_fake_time_us(0);
+
+  host::MockUART uart;
+  uart.set_rx_buffer_size(rx_buffer);
+  time::RealTimeClock rtc;
+  ReplayPanel panel;
+  panel.set_uart_parent(&uart);
+  panel.set_traffic_capture_size(64 * 1024);
+  configure_panel(panel, rtc);
+
+  uint32_t events_handled = 0;
+  panel.add_incoming_msg_callback([&](std::string) { events_handled++; });
+
+  // the frames sent answer the oldest unanswered event
+  std::vector<uint32_t> replay_latencies;
+  uint32_t replay_unanswered = 0, tx_frames = 0, tx_bytes = 0;
+  bool event_pending = false;
+  uint32_t event_at = 0;
+  uart.on_write = [&](const uint8_t *data, size_t length) {
+    tx_bytes += length;
+    if (length < 6 || data[0] != 0x55 || data[1] != 0xBB) return;
+    tx_frames++;
+    if (event_pending) {
+      replay_latencies.push_back(millis() - event_at);
+      event_pending = false;
+    }
+  };
+
+  panel.setup();
+  panel.start_traffic_capture();
+  rtc.synchronize_epoch(1700000000);
+
+  std::map<std::string, std::string> states;
+  for (auto &sub : api::global_api_server->get_subscriptions()) {
+    if (!sub.attribute.has_value()) states.emplace(sub.entity_id, initial_state(sub.entity_id));
+  }
+  for (auto &state : states) api::global_api_server->publish(state.first, "", state.second);
+
+  std::multimap<uint32_t, std::pair<std::string, std::string>> ha_updates; // time -> entity id, state
+  std::vector<queue_bucket> buckets((entries.back().time - entries.front().time + DRAIN_MS) / bucket_ms + 1);
+  uint32_t rx_bytes = 0, injected_events = 0, service_calls = 0;
+  std::map<char, uint32_t> injected;
+  size_t next = 0;
+  std::vector<uint8_t> rescan;
+  uint32_t rescan_time = 0;
+  std::chrono::duration<double> loop_time{};
+  auto end_ms = entries.back().time + offset + DRAIN_MS;
+
+  for (auto &entry : entries) {
+    if (entry.type != 'T') continue;
+    auto &bucket = buckets[(entry.time - entries.front().time) / bucket_ms];
+    bucket.capture_max = std::max<uint32_t>(bucket.capture_max, entry.queue_depth);
+  }
+
+  while (millis() < end_ms || !ha_updates.empty()) {
+    auto now = millis();
+    for (; next < entries.size() && entries[next].time + offset <= now; next++) {
+      auto &entry = entries[next];
+      std::vector<uint8_t> bytes;
+      if (entry.type == 'M') {
+        append_frame(bytes, entry.data);
+        if (is_event(entry)) {
+          if (event_pending) replay_unanswered++;
+          event_pending = true;
+          event_at = entry.time + offset;
+          injected_events++;
+        }
+      } else if (entry.type == 'C' || entry.type == 'I') {
+        // the decoder drops the first byte of a corrupt frame and rescans the rest,
+        // the records of the rescanned bytes don't hold bytes that were received again
+        if (entry.time == rescan_time &&
+            std::search(rescan.begin(), rescan.end(), entry.data.begin(), entry.data.end()) != rescan.end()) {
+          continue;
+        }
+        bytes = entry.data;
+        rescan.assign(entry.data.begin() + std::min<size_t>(entry.data.size(), 1), entry.data.end());
+        rescan_time = entry.time;
+      } else if (entry.type != 'T') {
+        // startup/ready sequences
+        bytes = entry.data;
+      }
+      if (bytes.empty()) continue;
+      injected[entry.type]++;
+      rx_bytes += bytes.size();
+      uart.inject(bytes.data(), bytes.size());
+    }
+    while (!ha_updates.empty() && ha_updates.begin()->first <= now) {
+      auto &update = ha_updates.begin()->second;
+      states[update.first] = update.second;
+      api::global_api_server->publish(update.first, "", update.second);
+      ha_updates.erase(ha_updates.begin());
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    host::run_scheduler();
+    panel.loop();
+    loop_time += std::chrono::steady_clock::now() - started;
+
+    for (auto &call : api::global_api_server->take_service_calls()) {
+      service_calls++;
+      for (auto &kv : call.data) {
+        if (kv.key != "entity_id") continue;
+        auto &state = states[kv.value];
+        ha_updates.emplace(now + ha_delay, std::make_pair(kv.value, state_after_call(call.service, state)));
+      }
+    }
+
+    if (now >= START_MS && (now - START_MS) / bucket_ms < buckets.size()) {
+      auto &bucket = buckets[(now - START_MS) / bucket_ms];
+      auto depth = panel.get_queue_depth();
+      bucket.replay_max = std::max<uint32_t>(bucket.replay_max, depth);
+      bucket.replay_sum += depth;
+      bucket.replay_samples++;
+    }
+
+    host::advance_fake_time_us(uint64_t(loop_interval) * 1000);
+    if (speed > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(uint64_t(loop_interval * 1000 / speed)));
+    }
+  }
+  if (event_pending) replay_unanswered++;
+
+  // what the panel sent during the replay, recorded like on the device
+  std::vector<capture_entry> replayed;
+  panel.get_traffic_capture().for_each([&](const capture_record &r, const uint8_t *data) {
+    replayed.push_back({r.time, static_cast<char>(r.type), r.queue_depth, r.wait,
+      std::vector<uint8_t>(data, data + r.length)});
+  });
+  if (dump_path != nullptr) {
+    FILE *file = std::fopen(dump_path, "w");
+    if (file == nullptr) {
+      std::fprintf(stderr, "can't write %s\n", dump_path);
+      return 1;
+    }
+    for (auto &entry : replayed) {
+      size_t n = std::min<size_t>(entry.data.size(), 96);
+      std::fprintf(file, "cap,%u,%c,%u,%u,%s\n", entry.time, entry.type, entry.queue_depth, entry.wait,
+        format_hex(entry.data.data(), n).c_str());
+      for (size_t i = n; i < entry.data.size(); i += 96) {
+        std::fprintf(file, "cap+,%s\n", format_hex(entry.data.data() + i, std::min<size_t>(entry.data.size() - i, 96)).c_str());
+      }
+    }
+    std::fclose(file);
+  }
+
+  uint32_t capture_unanswered = 0;
+  auto capture_latencies = response_latencies(entries, capture_unanswered);
+  std::vector<uint32_t> capture_waits, replay_waits, capture_depths, replay_depths;
+  for (auto &entry : entries) {
+    if (entry.type != 'T') continue;
+    capture_waits.push_back(entry.wait);
+    capture_depths.push_back(entry.queue_depth);
+  }
+  for (auto &entry : replayed) {
+    if (entry.type != 'T') continue;
+    replay_waits.push_back(entry.wait);
+    replay_depths.push_back(entry.queue_depth);
+  }
+
+  std::printf("capture: %s, %zu records over %.1fs, %u records dropped on the panel\n", capture_path,
+    entries.size(), (entries.back().time - entries.front().time) / 1000.0, capture_dropped);
+  char speed_str[16] = "max";
+  if (speed > 0) std::snprintf(speed_str, sizeof(speed_str), "%gx", speed);
+  std::printf("replay: loop interval %ums, speed %s, rx buffer %zu bytes, ha delay %ums\n", loop_interval,
+    speed_str, rx_buffer, ha_delay);
+
+  std::printf("\nparse throughput\n");
+  std::printf("  rx: %u bytes (M %u, S %u, R %u, C %u, I %u)\n", rx_bytes, injected['M'], injected['S'],
+    injected['R'], injected['C'], injected['I']);
+  std::printf("  loop(): %.2fms in total, %.0f rx bytes/sec\n", loop_time.count() * 1000,
+    loop_time.count() > 0 ? rx_bytes / loop_time.count() : 0.0);
+
+  std::printf("\ndropped frames\n");
+  std::printf("  events: %u sent by the TFT, %u handled\n", injected_events, events_handled);
+  std::printf("  uart overflow: %u bytes\n", uart.get_rx_overflow_bytes());
+  std::printf("  decoder: %u bytes dropped, %u crc errors\n", panel.get_rx_dropped_bytes(), panel.get_rx_crc_errors());
+  std::printf("  tx: %u frames (%u bytes), %u queue overflows\n", tx_frames, tx_bytes, panel.get_queue_overflows());
+  std::printf("  home assistant: %u service calls\n", service_calls);
+
+  std::printf("\n  %-22s %6s %7s %5s %5s %5s   %6s %7s %5s %5s %5s\n", "",
+    "count", "mean", "p50", "p95", "max", "count", "mean", "p50", "p95", "max");
+  std::printf("  %-22s %35s   %35s\n", "", "capture", "replay");
+  print_stats("event -> response ms", capture_latencies, replay_latencies);
+  print_stats("queue wait ms", capture_waits, replay_waits);
+  print_stats("queue depth at send", capture_depths, replay_depths);
+  std::printf("  unanswered events: %u in the capture, %u in the replay\n", capture_unanswered, replay_unanswered);
+
+  std::printf("\nqueue depth over time\n");
+  std::printf("  %8s %12s %12s %12s\n", "time s", "capture max", "replay max", "replay mean");
+  for (size_t i = 0; i < buckets.size(); i++) {
+    auto &bucket = buckets[i];
+    std::printf("  %8.1f %12u %12u %12.2f\n", i * bucket_ms / 1000.0, bucket.capture_max, bucket.replay_max,
+      bucket.replay_samples == 0 ? 0.0 : double(bucket.replay_sum) / bucket.replay_samples);
+  }
+
+  // every event written to the UART must have reached the component
+  if (events_handled != injected_events) {
+    std::fprintf(stderr, "%u events were lost\n", injected_events - events_handled);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+enum gpio_num_t { GPIO_NUM_4 = 4 };
+
+inline int gpio_set_level(gpio_num_t gpio_num, uint32_t level) { return 0; }
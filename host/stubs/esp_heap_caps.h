@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+#define MALLOC_CAP_8BIT (1 << 2)
+
+namespace esphome {
+namespace host {
+// Simulated PSRAM, 0 for panels without it
+extern size_t psram_size;
+} // namespace host
+} // namespace esphome
+
+// The host has no separate heaps, PSRAM allocations come from malloc too
+inline size_t heap_caps_get_total_size(int caps) {
+  return (caps & MALLOC_CAP_SPIRAM) ? esphome::host::psram_size : 0;
+}
+inline size_t heap_caps_get_free_size(int caps) {
+  return (caps & MALLOC_CAP_SPIRAM) ? esphome::host::psram_size : 0;
+}
+inline size_t heap_caps_get_minimum_free_size(int) { return 0; }
+inline size_t heap_caps_get_largest_free_block(int) { return 0; }
+inline void *heap_caps_malloc(size_t size, int) { return malloc(size); }
+inline void *heap_caps_realloc(void *ptr, size_t size, int) { return realloc(ptr, size); }
+inline void heap_caps_free(void *ptr) { free(ptr); }
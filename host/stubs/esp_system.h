@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+
+enum esp_reset_reason_t { ESP_RST_UNKNOWN, ESP_RST_POWERON, ESP_RST_SW, ESP_RST_DEEPSLEEP, ESP_RST_USB };
+
+// Every host run is a cold start
+inline esp_reset_reason_t esp_reset_reason() { return ESP_RST_POWERON; }
+inline uint32_t esp_get_free_heap_size() { return 0; }
+inline uint32_t esp_get_minimum_free_heap_size() { return 0; }
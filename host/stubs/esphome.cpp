@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "esphome/core/application.h"
+#include "esphome/core/component.h"
+#include "esphome/core/host.h"
+#include "esphome/core/preferences.h"
+#include "esphome/core/time.h"
+#include "esphome/components/api/custom_api_device.h"
+#include "esphome/components/time/real_time_clock.h"
+
+namespace esphome {
+
+namespace setup_priority {
+const float DATA = 600.0f;
+const float LATE = -100.0f;
+} // namespace setup_priority
+
+Application App;
+
+static ESPPreferences preferences;
+ESPPreferences *global_preferences = &preferences;
+
+namespace {
+
+struct scheduler_item {
+  Component *component;
+  std::string name;
+  uint32_t interval; // 0 for a timeout
+  uint64_t next_run; // ms
+  uint64_t id;       // order of creation, runs items due at the same time in that order
+  std::function<void()> f;
+  bool removed;
+};
+
+std::vector<std::unique_ptr<scheduler_item>> scheduler_items;
+uint64_t scheduler_next_id = 0;
+
+uint64_t now_ms() { return host::now_us() / 1000; }
+
+bool cancel_item(Component *component, const std::string &name, bool interval) {
+  bool found = false;
+  for (auto &item : scheduler_items) {
+    if (item->removed || item->component != component || item->name != name) continue;
+    if ((item->interval != 0) != interval) continue;
+    item->removed = true;
+    found = true;
+  }
+  return found;
+}
+
+void add_item(Component *component, const std::string &name, uint32_t delay, uint32_t interval,
+    std::function<void()> &&f) {
+  // a named item replaces the one of the component with the same name
+  if (!name.empty()) cancel_item(component, name, interval != 0);
+  scheduler_items.emplace_back(new scheduler_item{
+    component, name, interval, now_ms() + delay, scheduler_next_id++, std::move(f), false});
+}
+
+} // namespace
+
+Component::~Component() {
+  for (auto &item : scheduler_items) {
+    if (item->component == this) item->removed = true;
+  }
+}
+
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+  add_item(this, name, timeout, 0, std::move(f));
+}
+void Component::set_timeout(uint32_t timeout, std::function<void()> &&f) {
+  add_item(this, "", timeout, 0, std::move(f));
+}
+bool Component::cancel_timeout(const std::string &name) { return cancel_item(this, name, false); }
+
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+  add_item(this, name, interval, std::max<uint32_t>(interval, 1), std::move(f));
+}
+void Component::set_interval(uint32_t interval, std::function<void()> &&f) {
+  add_item(this, "", interval, std::max<uint32_t>(interval, 1), std::move(f));
+}
+bool Component::cancel_interval(const std::string &name) { return cancel_item(this, name, true); }
+
+namespace host {
+
+void run_scheduler() {
+  auto last_id = scheduler_next_id;
+  while (true) {
+    auto now = now_ms();
+    scheduler_item *next = nullptr;
+    for (auto &item : scheduler_items) {
+      if (item->removed || item->id >= last_id || item->next_run > now) continue;
+      if (next == nullptr || item->next_run < next->next_run ||
+          (item->next_run == next->next_run && item->id < next->id)) {
+        next = item.get();
+      }
+    }
+    if (next == nullptr) break;
+
+    if (next->interval == 0) {
+      next->removed = true;
+      // the item can't be freed while its function runs, move the function out
+      auto f = std::move(next->f);
+      f();
+    } else {
+      next->next_run += next->interval;
+      // an interval that fell behind runs once, not once for every period it missed
+      if (next->next_run <= now) next->next_run = now + next->interval;
+      next->f();
+    }
+  }
+  scheduler_items.erase(std::remove_if(scheduler_items.begin(), scheduler_items.end(),
+    [](const std::unique_ptr<scheduler_item> &item) { return item->removed; }), scheduler_items.end());
+}
+
+} // namespace host
+
+std::string ESPTime::strftime(const std::string &format) {
+  struct tm c_tm {};
+  c_tm.tm_sec = this->second;
+  c_tm.tm_min = this->minute;
+  c_tm.tm_hour = this->hour;
+  c_tm.tm_mday = this->day_of_month;
+  c_tm.tm_mon = this->month - 1;
+  c_tm.tm_year = this->year - 1900;
+  c_tm.tm_wday = this->day_of_week - 1;
+  c_tm.tm_yday = this->day_of_year - 1;
+  c_tm.tm_isdst = this->is_dst;
+  char buffer[128];
+  size_t length = ::strftime(buffer, sizeof(buffer), format.c_str(), &c_tm);
+  return length == 0 ? "ERROR" : std::string(buffer, length);
+}
+
+ESPTime ESPTime::from_c_tm(struct tm *c_tm, time_t c_time) {
+  ESPTime res{};
+  res.second = c_tm->tm_sec;
+  res.minute = c_tm->tm_min;
+  res.hour = c_tm->tm_hour;
+  res.day_of_week = c_tm->tm_wday + 1;
+  res.day_of_month = c_tm->tm_mday;
+  res.day_of_year = c_tm->tm_yday + 1;
+  res.month = c_tm->tm_mon + 1;
+  res.year = c_tm->tm_year + 1900;
+  res.is_dst = c_tm->tm_isdst;
+  res.timestamp = c_time;
+  return res;
+}
+
+ESPTime ESPTime::from_epoch_utc(time_t epoch) {
+  struct tm c_tm {};
+  gmtime_r(&epoch, &c_tm);
+  return from_c_tm(&c_tm, epoch);
+}
+
+namespace time {
+
+ESPTime RealTimeClock::now() {
+  if (this->epoch_ == 0) return ESPTime::from_epoch_utc(0);
+  return ESPTime::from_epoch_utc(this->epoch_ + (millis() - this->synchronized_at_) / 1000);
+}
+
+void RealTimeClock::synchronize_epoch(uint32_t epoch) {
+  this->epoch_ = epoch;
+  this->synchronized_at_ = millis();
+  for (auto &callback : this->time_sync_callbacks_) callback();
+}
+
+} // namespace time
+
+namespace api {
+
+static APIServer api_server;
+APIServer *global_api_server = &api_server;
+
+void APIServer::subscribe_home_assistant_state(std::string entity_id, optional<std::string> attribute,
+    std::function<void(std::string)> f) {
+  this->subscriptions_.push_back({std::move(entity_id), std::move(attribute), std::move(f)});
+}
+
+void APIServer::send_homeassistant_service_call(const HomeassistantServiceResponse &call) {
+  this->service_calls_.push_back(call);
+}
+
+size_t APIServer::publish(const std::string &entity_id, const std::string &attribute, const std::string &value) {
+  size_t count = 0;
+  for (auto &sub : this->subscriptions_) {
+    if (sub.entity_id != entity_id || sub.attribute.value_or("") != attribute) continue;
+    sub.callback(value);
+    count++;
+  }
+  return count;
+}
+
+} // namespace api
+} // namespace esphome
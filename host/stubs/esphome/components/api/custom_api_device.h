@@ -0,0 +1,54 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace api {
+
+struct HomeassistantServiceMap {
+  std::string key;
+  std::string value;
+};
+
+struct HomeassistantServiceResponse {
+  std::string service;
+  std::vector<HomeassistantServiceMap> data;
+  std::vector<HomeassistantServiceMap> data_template;
+  std::vector<HomeassistantServiceMap> variables;
+  bool is_event = false;
+};
+
+// Stands in for Home Assistant: a host program publishes the states
+// and reads the service calls made by the component
+class APIServer {
+public:
+  void subscribe_home_assistant_state(std::string entity_id, optional<std::string> attribute,
+    std::function<void(std::string)> f);
+  void send_homeassistant_service_call(const HomeassistantServiceResponse &call);
+
+  struct subscription {
+    std::string entity_id;
+    optional<std::string> attribute;
+    std::function<void(std::string)> callback;
+  };
+  const std::vector<subscription> &get_subscriptions() const { return this->subscriptions_; }
+  // Calls the callbacks subscribed to the state (empty attribute) or attribute of the entity
+  size_t publish(const std::string &entity_id, const std::string &attribute, const std::string &value);
+
+  // Service calls made since the last call, oldest first
+  std::vector<HomeassistantServiceResponse> take_service_calls() { return std::move(this->service_calls_); }
+
+protected:
+  std::vector<subscription> subscriptions_;
+  std::vector<HomeassistantServiceResponse> service_calls_;
+};
+
+extern APIServer *global_api_server;
+
+class CustomAPIDevice {};
+
+} // namespace api
+} // namespace esphome
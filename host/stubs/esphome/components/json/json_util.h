@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Just enough of ArduinoJson's interface to build the component,
+// nothing is parsed: deserializeJson() always fails, so the weather forecast is skipped on the host
+namespace ArduinoJson {
+
+class DeserializationError {
+public:
+  explicit operator bool() const { return true; }
+  const char *c_str() const { return "NotSupported"; }
+};
+
+class JsonVariant {
+public:
+  template<typename T> T as() const { return T(); }
+  JsonVariant operator[](const char *key) const { return {}; }
+  JsonVariant operator[](int index) const { return {}; }
+  template<typename T> JsonVariant &operator=(T value) { return *this; }
+  operator const char *() const { return nullptr; }
+};
+
+class JsonObject : public JsonVariant {};
+
+class JsonArray {
+public:
+  JsonObject *begin() const { return nullptr; }
+  JsonObject *end() const { return nullptr; }
+};
+
+template<size_t N> class StaticJsonDocument {
+public:
+  JsonVariant operator[](int index) { return {}; }
+  bool overflowed() const { return false; }
+};
+
+template<typename TAllocator> class BasicJsonDocument {
+public:
+  explicit BasicJsonDocument(size_t capacity) {}
+  JsonVariant operator[](int index) const { return {}; }
+  bool overflowed() const { return false; }
+  size_t size() const { return 0; }
+  template<typename T> T as() const { return T(); }
+};
+
+struct DeserializationOption {
+  template<typename TFilter> static int Filter(TFilter &filter) { return 0; }
+};
+
+template<typename TDocument, typename TOption>
+DeserializationError deserializeJson(TDocument &doc, char *input, TOption option) { return {}; }
+
+} // namespace ArduinoJson
+
+using namespace ArduinoJson;
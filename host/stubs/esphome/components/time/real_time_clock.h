@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "esphome/core/component.h"
+#include "esphome/core/time.h"
+
+namespace esphome {
+namespace time {
+
+// Runs on UTC, the time is invalid until a host program calls synchronize_epoch()
+class RealTimeClock : public Component {
+public:
+  ESPTime now();
+  void add_on_time_sync_callback(std::function<void()> &&callback) {
+    this->time_sync_callbacks_.push_back(std::move(callback));
+  }
+  // The current time is 'epoch' from now on, it follows millis()
+  void synchronize_epoch(uint32_t epoch);
+
+protected:
+  std::vector<std::function<void()>> time_sync_callbacks_;
+  uint32_t epoch_ = 0;
+  uint32_t synchronized_at_ = 0; // millis()
+};
+
+} // namespace time
+} // namespace esphome
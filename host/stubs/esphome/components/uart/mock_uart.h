@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstring>
+#include <deque>
+#include <functional>
+#include "esphome/components/uart/uart_component_esp_idf.h"
+
+namespace esphome {
+namespace host {
+
+// The UART of the panel: bytes injected by the host program are read by the
+// uart::UARTDevice (NSPanelLovelace) and its writes are passed to 'on_write'.
+// Bytes that don't fit into the RX buffer are lost, like with the driver's ring buffer.
+class MockUART : public uart::IDFUARTComponent {
+public:
+  void inject(const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      if (this->rx_.size() >= this->rx_buffer_size_) {
+        this->rx_overflow_bytes_ += length - i;
+        break;
+      }
+      this->rx_.push_back(data[i]);
+    }
+  }
+
+  void write_array(const uint8_t *data, size_t len) override {
+    if (this->on_write) this->on_write(data, len);
+  }
+  bool peek_byte(uint8_t *data) override {
+    if (this->rx_.empty()) return false;
+    *data = this->rx_.front();
+    return true;
+  }
+  bool read_array(uint8_t *data, size_t len) override {
+    if (this->rx_.size() < len) return false;
+    for (size_t i = 0; i < len; i++) {
+      data[i] = this->rx_.front();
+      this->rx_.pop_front();
+    }
+    return true;
+  }
+  int available() override { return static_cast<int>(this->rx_.size()); }
+  void flush() override {}
+
+  uint32_t get_rx_overflow_bytes() const { return this->rx_overflow_bytes_; }
+
+  std::function<void(const uint8_t *data, size_t length)> on_write;
+
+protected:
+  std::deque<uint8_t> rx_;
+  uint32_t rx_overflow_bytes_ = 0;
+};
+
+} // namespace host
+} // namespace esphome
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace uart {
+
+// The bus, a host program implements it to feed and collect the bytes
+class UARTComponent {
+public:
+  virtual ~UARTComponent() = default;
+
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual bool peek_byte(uint8_t *data) = 0;
+  virtual bool read_array(uint8_t *data, size_t len) = 0;
+  virtual int available() = 0;
+  virtual void flush() = 0;
+  virtual void load_settings(bool dump_config = true) {}
+
+  void set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
+  uint32_t get_baud_rate() const { return this->baud_rate_; }
+  void set_rx_buffer_size(size_t rx_buffer_size) { this->rx_buffer_size_ = rx_buffer_size; }
+  size_t get_rx_buffer_size() { return this->rx_buffer_size_; }
+
+protected:
+  uint32_t baud_rate_ = 115200;
+  size_t rx_buffer_size_ = 256;
+};
+
+// Forwards to the bus like the ESPHome UARTDevice
+class UARTDevice {
+public:
+  UARTDevice() = default;
+  explicit UARTDevice(UARTComponent *parent) : parent_(parent) {}
+
+  void set_uart_parent(UARTComponent *parent) { this->parent_ = parent; }
+
+  void write_byte(uint8_t data) { this->parent_->write_array(&data, 1); }
+  void write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
+  void write_array(const std::vector<uint8_t> &data) { this->parent_->write_array(data.data(), data.size()); }
+  template<size_t N> void write_array(const std::array<uint8_t, N> &data) {
+    this->parent_->write_array(data.data(), data.size());
+  }
+  void write_str(const char *str) {
+    this->parent_->write_array(reinterpret_cast<const uint8_t *>(str), std::strlen(str));
+  }
+
+  bool read_byte(uint8_t *data) { return this->parent_->read_array(data, 1); }
+  bool peek_byte(uint8_t *data) { return this->parent_->peek_byte(data); }
+  bool read_array(uint8_t *data, size_t len) { return this->parent_->read_array(data, len); }
+  int available() { return this->parent_->available(); }
+  void flush() { this->parent_->flush(); }
+
+protected:
+  UARTComponent *parent_{nullptr};
+};
+
+} // namespace uart
+} // namespace esphome
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "esphome/components/uart/uart.h"
+
+namespace esphome {
+namespace uart {
+
+// A host program derives its bus from it where the component expects the ESP-IDF UART,
+// the driver's event queue (USE_NSPANEL_UART_EVENTS) isn't available on the host
+class IDFUARTComponent : public UARTComponent, public Component {
+public:
+  void setup() override { this->load_settings(false); }
+};
+
+} // namespace uart
+} // namespace esphome
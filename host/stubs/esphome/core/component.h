@@ -0,0 +1,37 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+namespace setup_priority {
+extern const float DATA;
+extern const float LATE;
+} // namespace setup_priority
+
+// The timeouts and intervals are run by host::run_scheduler(),
+// which takes the place of the scheduler in the ESPHome main loop
+class Component {
+public:
+  virtual ~Component();
+
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+
+protected:
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+  void set_timeout(uint32_t timeout, std::function<void()> &&f);
+  bool cancel_timeout(const std::string &name);
+  void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+  void set_interval(uint32_t interval, std::function<void()> &&f);
+  bool cancel_interval(const std::string &name);
+  void defer(std::function<void()> &&f) { this->set_timeout(0, std::move(f)); }
+};
+
+class PollingComponent : public Component {};
+
+} // namespace esphome
@@ -0,0 +1,7 @@
+#pragma once
+
+// What the generated defines.h holds for an ESP-IDF build of the panel,
+// the UART event task and TFT upload aren't supported on the host
+#define USE_API
+#define USE_ESP_IDF
+#define USE_TIME
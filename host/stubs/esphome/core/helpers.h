@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "esphome/core/log.h"
+
+namespace esphome {
+
+inline uint16_t encode_uint16(uint8_t msb, uint8_t lsb) { return (uint16_t(msb) << 8) | lsb; }
+uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc = 0xffff, uint16_t reverse_poly = 0xa001,
+  bool refin = false, bool refout = false);
+uint32_t fnv1_hash(const std::string &str);
+std::string format_hex(const uint8_t *data, size_t length);
+std::string format_hex(const std::vector<uint8_t> &data);
+std::string str_snprintf(const char *fmt, size_t len, ...);
+inline bool str_startswith(const std::string &str, const std::string &start) { return str.rfind(start, 0) == 0; }
+template<typename T> std::string to_string(T value) { return std::to_string(value); }
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void yield();
+
+template<typename T> class optional {
+public:
+  optional() = default;
+  optional(T value) : value_(std::move(value)), has_value_(true) {}
+  bool has_value() const { return this->has_value_; }
+  T &value() { return this->value_; }
+  const T &value() const { return this->value_; }
+  T value_or(T other) const { return this->has_value_ ? this->value_ : other; }
+
+protected:
+  T value_{};
+  bool has_value_ = false;
+};
+
+template<typename... Ts> class CallbackManager;
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &callback : this->callbacks_) callback(args...);
+  }
+  size_t size() const { return this->callbacks_.size(); }
+
+protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+} // namespace esphome
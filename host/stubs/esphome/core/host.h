@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// Controls for the host stubs, not part of ESPHome
+namespace esphome {
+namespace host {
+
+// ESPHOME_LOG_LEVEL_* of the messages written to stderr
+extern int log_level;
+
+// millis()/micros() follow this clock instead of the real time when it is set,
+// so code can be driven at real or accelerated speed
+void set_fake_time_us(uint64_t now);
+void advance_fake_time_us(uint64_t duration);
+void use_real_time();
+uint64_t now_us();
+
+// Runs the timeouts and intervals of the components that are due,
+// the ones added while running are left for the next call
+void run_scheduler();
+
+} // namespace host
+} // namespace esphome
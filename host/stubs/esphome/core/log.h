@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+#include "esphome/core/host.h"
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+
+#define ESPHOME_HOST_LOG_(level, letter, tag, format, ...) \
+  do { \
+    if (esphome::host::log_level >= (level)) \
+      std::fprintf(stderr, "[" letter "][%s] " format "\n", tag, ##__VA_ARGS__); \
+  } while (0)
+
+#define ESP_LOGE(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_ERROR, "E", tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_WARN, "W", tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_INFO, "I", tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_CONFIG, "C", tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_DEBUG, "D", tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_VERBOSE, "V", tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_VERY_VERBOSE, "VV", tag, __VA_ARGS__)
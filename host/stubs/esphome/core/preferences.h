@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+// Nothing is persisted on the host, every run starts with the defaults
+class ESPPreferenceObject {
+public:
+  template<typename T> bool save(const T *src) { return true; }
+  template<typename T> bool load(T *dest) { return false; }
+};
+
+class ESPPreferences {
+public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) { return {}; }
+};
+
+extern ESPPreferences *global_preferences;
+
+} // namespace esphome
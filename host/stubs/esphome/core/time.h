@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+namespace esphome {
+
+struct ESPTime {
+  uint8_t second;
+  uint8_t minute;
+  uint8_t hour;
+  uint8_t day_of_week;  // 1-7, sunday is 1
+  uint8_t day_of_month; // 1-31
+  uint16_t day_of_year; // 1-366
+  uint8_t month;        // 1-12
+  uint16_t year;
+  bool is_dst;
+  time_t timestamp;
+
+  bool is_valid() const { return this->year >= 2019; }
+  std::string strftime(const std::string &format);
+
+  static ESPTime from_c_tm(struct tm *c_tm, time_t c_time);
+  static ESPTime from_epoch_utc(time_t epoch);
+};
+
+} // namespace esphome
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
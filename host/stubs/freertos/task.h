@@ -0,0 +1,7 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+#include <freertos/FreeRTOS.h>
+
+// A tick is a millisecond, the delay follows the host clock
+inline void vTaskDelay(TickType_t ticks) { esphome::delay(ticks); }
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <thread>
+#include "esphome/core/helpers.h"
+#include "esphome/core/host.h"
+#include <esp_heap_caps.h>
+
+namespace esphome {
+namespace host {
+
+int log_level = ESPHOME_LOG_LEVEL_WARN;
+size_t psram_size = 0;
+
+static bool fake_time = false;
+static uint64_t fake_now = 0;
+
+void set_fake_time_us(uint64_t now) {
+  fake_time = true;
+  fake_now = now;
+}
+void advance_fake_time_us(uint64_t duration) { fake_now += duration; }
+void use_real_time() { fake_time = false; }
+
+uint64_t now_us() {
+  if (fake_time) return fake_now;
+  static auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace host
+
+uint16_t crc16(const uint8_t *data, uint16_t len, uint16_t crc, uint16_t reverse_poly, bool refin, bool refout) {
+  if (refin) crc ^= 0xffff;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      if (crc & 0x0001) crc = (crc >> 1) ^ reverse_poly;
+      else crc >>= 1;
+    }
+  }
+  return refout ? (crc ^ 0xffff) : crc;
+}
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= c;
+  }
+  return hash;
+}
+
+std::string format_hex(const uint8_t *data, size_t length) {
+  static const char digits[] = "0123456789abcdef";
+  std::string ret;
+  ret.reserve(length * 2);
+  for (size_t i = 0; i < length; i++) {
+    ret.append(1, digits[data[i] >> 4]).append(1, digits[data[i] & 0x0F]);
+  }
+  return ret;
+}
+std::string format_hex(const std::vector<uint8_t> &data) { return format_hex(data.data(), data.size()); }
+
+std::string str_snprintf(const char *fmt, size_t len, ...) {
+  std::string str(len, '\0');
+  va_list args;
+  va_start(args, len);
+  size_t out_length = vsnprintf(&str[0], len + 1, fmt, args);
+  va_end(args);
+  str.resize(std::min(out_length, len));
+  return str;
+}
+
+uint32_t millis() { return static_cast<uint32_t>(host::now_us() / 1000); }
+uint32_t micros() { return static_cast<uint32_t>(host::now_us()); }
+void delay(uint32_t ms) {
+  // blocks on the device, simulated time just moves on
+  if (host::fake_time) host::advance_fake_time_us(uint64_t(ms) * 1000);
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+void yield() {}
+
+} // namespace esphome
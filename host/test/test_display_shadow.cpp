@@ -0,0 +1,82 @@
+// Commands the DisplayShadow doesn't track must not make it skip the frames that follow:
+// a notification is cleared by re-sending the screensaver page, and a custom
+// command can change what the page shows.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "esphome/core/host.h"
+#include "esphome/components/uart/mock_uart.h"
+
+#include "nspanel_lovelace.h"
+#include "pages.h"
+
+using namespace esphome;
+using namespace esphome::nspanel_lovelace;
+
+namespace {
+
+std::vector<std::string> sent;
+
+// Runs loop() until everything queued has been sent
+void run(NSPanelLovelace &panel, uint32_t ms = 2000) {
+  for (uint32_t t = 0; t < ms; t += 16) {
+    host::run_scheduler();
+    panel.loop();
+    host::advance_fake_time_us(16000);
+  }
+}
+
+bool was_sent(const std::string &prefix) {
+  for (auto &payload : sent) {
+    if (payload.compare(0, prefix.length(), prefix) == 0) return true;
+  }
+  return false;
+}
+
+bool check(bool ok, const char *what) {
+  std::printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+} // namespace
+
+int main() {
+  host::set_fake_time_us(0);
+  host::MockUART uart;
+  uart.on_write = [](const uint8_t *data, size_t length) {
+    if (length < 6 || data[0] != 0x55 || data[1] != 0xBB) return;
+    sent.emplace_back(reinterpret_cast<const char *>(data) + 4, length - 6);
+  };
+  NSPanelLovelace panel;
+  panel.set_uart_parent(&uart);
+  panel.insert_page<Screensaver>(0, "1");
+  panel.setup();
+  run(panel);
+
+  bool ok = true;
+  panel.render_screensaver();
+  run(panel);
+  ok &= check(was_sent("pageType~screensaver"), "screensaver rendered");
+
+  sent.clear();
+  panel.notify_on_screensaver("Heading", "Message", 1000);
+  run(panel, 500);
+  ok &= check(was_sent("notify~Heading~Message"), "notification sent");
+  run(panel, 1000);
+  ok &= check(was_sent("pageType~screensaver"), "screensaver re-sent after the notification timed out");
+
+  sent.clear();
+  panel.send_display_command("notify~Heading~Message");
+  panel.render_screensaver();
+  run(panel);
+  ok &= check(was_sent("pageType~screensaver"), "screensaver re-sent after a custom command");
+
+  sent.clear();
+  panel.render_screensaver();
+  run(panel);
+  ok &= check(!was_sent("pageType~screensaver"), "unchanged screensaver skipped");
+
+  return ok ? 0 : 1;
+}